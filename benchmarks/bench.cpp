@@ -0,0 +1,638 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sigfn.h>
+#include <sigfn.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*
+ * sigfn_bench [--json] [iterations]
+ *
+ * Every benchmark produces one sample per measured event and is reported as
+ * a row of summary statistics in CSV (default) or JSON. ops_per_s is the
+ * number of operations divided by the total time they took, so for latency
+ * rows it is the serial rate and for kill storm rows, whose samples are the
+ * gaps between consecutive handler invocations, it is the delivered signal
+ * rate. Check rows time whole batches, since a single check is below the
+ * clock resolution; their samples are per-check averages.
+ */
+
+namespace
+{
+    typedef std::chrono::steady_clock bench_clock;
+
+    struct result
+    {
+        std::string name;
+        std::vector<std::chrono::nanoseconds> samples;
+        // when set, the operations behind the samples and the total time
+        // they took, otherwise one operation per sample
+        uint64_t operations = 0;
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    struct summary
+    {
+        std::size_t count;
+        int64_t min;
+        int64_t mean;
+        int64_t p50;
+        int64_t p99;
+        int64_t max;
+        uint64_t ops_per_s;
+    };
+
+    summary summarize(const result &result)
+    {
+        summary summary{0, 0, 0, 0, 0, 0, 0};
+        std::vector<std::chrono::nanoseconds> sorted(result.samples);
+        if (sorted.empty())
+        {
+            return summary;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        const std::chrono::nanoseconds total = std::accumulate(sorted.begin(), sorted.end(), std::chrono::nanoseconds(0));
+        summary.count = sorted.size();
+        summary.min = sorted.front().count();
+        summary.mean = (total / summary.count).count();
+        summary.p50 = sorted[summary.count / 2].count();
+        summary.p99 = sorted[(summary.count * 99) / 100].count();
+        summary.max = sorted.back().count();
+        const uint64_t operations = (result.operations != 0) ? result.operations : summary.count;
+        const std::chrono::nanoseconds elapsed = (result.operations != 0) ? result.elapsed : total;
+        if (elapsed.count() > 0)
+        {
+            summary.ops_per_s = static_cast<uint64_t>((static_cast<double>(operations) * 1e9) / static_cast<double>(elapsed.count()));
+        }
+        return summary;
+    }
+
+    void report_csv(const std::vector<result> &results)
+    {
+        std::cout << "benchmark,samples,min_ns,mean_ns,p50_ns,p99_ns,max_ns,ops_per_s" << std::endl;
+        for (const result &result : results)
+        {
+            const summary summary = summarize(result);
+            std::cout << result.name << ','
+                      << summary.count << ','
+                      << summary.min << ','
+                      << summary.mean << ','
+                      << summary.p50 << ','
+                      << summary.p99 << ','
+                      << summary.max << ','
+                      << summary.ops_per_s << std::endl;
+        }
+    }
+
+    void report_json(const std::vector<result> &results)
+    {
+        std::cout << "{\"benchmarks\":[";
+        for (std::size_t index = 0; index < results.size(); index++)
+        {
+            const summary summary = summarize(results[index]);
+            std::cout << (index == 0 ? "" : ",") << std::endl
+                      << "  {\"name\":\"" << results[index].name << "\","
+                      << "\"samples\":" << summary.count << ','
+                      << "\"min_ns\":" << summary.min << ','
+                      << "\"mean_ns\":" << summary.mean << ','
+                      << "\"p50_ns\":" << summary.p50 << ','
+                      << "\"p99_ns\":" << summary.p99 << ','
+                      << "\"max_ns\":" << summary.max << ','
+                      << "\"ops_per_s\":" << summary.ops_per_s << '}';
+        }
+        std::cout << std::endl
+                  << "]}" << std::endl;
+    }
+
+    std::chrono::nanoseconds since(const bench_clock::time_point &start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start);
+    }
+
+    // timestamp written by the handler under test
+    std::atomic<bench_clock::rep> handled(0);
+
+    void record_handled(int, void *)
+    {
+        handled = bench_clock::now().time_since_epoch().count();
+    }
+
+    // measures the time from raise() until the handler runs; raise() delivers
+    // synchronously to the calling thread, so the handler has run on return
+    template <class Register>
+    result raise_latency(const std::string &name, std::size_t iterations, int signum, Register &&install)
+    {
+        result result{name, {}};
+        result.samples.reserve(iterations);
+        install();
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            const bench_clock::time_point start = bench_clock::now();
+            std::raise(signum);
+            result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                bench_clock::duration(handled.load()) - start.time_since_epoch()));
+        }
+        sigfn::reset(signum);
+        return result;
+    }
+
+    // measures a single registration call, including retiring the previous entry
+    template <class Register>
+    result registration_cost(const std::string &name, std::size_t iterations, int signum, Register &&install)
+    {
+        result result{name, {}};
+        result.samples.reserve(iterations);
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            const bench_clock::time_point start = bench_clock::now();
+            install();
+            result.samples.push_back(since(start));
+        }
+        sigfn::reset(signum);
+        return result;
+    }
+
+    // number of checks a check_cost sample is averaged over
+    constexpr std::size_t check_batch = 1000;
+
+    // keeps the checks under test from being optimized away
+    std::atomic<std::size_t> checked(0);
+
+    // measures one hot-loop "has the signal arrived" check; a single check is
+    // far below the clock resolution, so each sample is a batch average
+    template <class Check>
+    result check_cost(const std::string &name, std::size_t iterations, int signum, Check &&check)
+    {
+        result result{name, {}};
+        result.samples.reserve(iterations);
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            std::size_t hits(0);
+            const bench_clock::time_point start = bench_clock::now();
+            for (std::size_t index = 0; index < check_batch; index++)
+            {
+                hits += check() ? 1 : 0;
+            }
+            const std::chrono::nanoseconds batch = since(start);
+            result.samples.push_back(batch / check_batch);
+            result.operations += check_batch;
+            result.elapsed += batch;
+            checked += hits;
+        }
+        sigfn::reset(signum);
+        return result;
+    }
+
+#ifndef _WIN32
+    // the pre-sigtimedwait implementation: replace the handler with one that
+    // fulfills a promise, then block on the future
+    int legacy_wait(int signum, std::atomic<bool> &ready)
+    {
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        sigfn::handle(
+            signum,
+            [&](int value)
+            {
+                promise.set_value(value);
+            });
+        ready = true;
+        return future.get();
+    }
+
+    // measures the time from pthread_kill() until the waiting thread resumes
+    template <class Wait>
+    result wakeup_latency(const std::string &name, std::size_t iterations, Wait &&wait)
+    {
+        result result{name, {}};
+        std::atomic<bool> ready(false);
+        std::atomic<bool> woken(false);
+        std::atomic<bench_clock::rep> sent(0);
+        result.samples.reserve(iterations);
+        std::thread waiter(
+            [&]()
+            {
+                for (std::size_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    wait(ready);
+                    const bench_clock::duration elapsed = bench_clock::now().time_since_epoch() - bench_clock::duration(sent.load());
+                    result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+                    woken = true;
+                }
+            });
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            while (!ready.exchange(false))
+            {
+                std::this_thread::yield();
+            }
+            sent = bench_clock::now().time_since_epoch().count();
+            pthread_kill(waiter.native_handle(), SIGUSR1);
+            while (!woken.exchange(false))
+            {
+                std::this_thread::yield();
+            }
+        }
+        waiter.join();
+        return result;
+    }
+
+    // a child process sends iterations signals back to back; samples are the
+    // gaps between handler invocations in the parent. standard signals
+    // coalesce while pending, realtime signals queue up to RLIMIT_SIGPENDING,
+    // so the sample count shows how many deliveries survived the storm
+    result kill_storm(const std::string &name, std::size_t iterations, int signum)
+    {
+        result result{name, {}};
+        std::vector<bench_clock::rep> arrivals(iterations);
+        std::atomic<std::size_t> arrived(0);
+        sigfn::handle(
+            signum,
+            [&](int)
+            {
+                const std::size_t index = arrived.fetch_add(1);
+                if (index < arrivals.size())
+                {
+                    arrivals[index] = bench_clock::now().time_since_epoch().count();
+                }
+            });
+        const pid_t parent = getpid();
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            for (std::size_t iteration = 0; iteration < iterations; iteration++)
+            {
+                kill(parent, signum);
+            }
+            _exit(0);
+        }
+        if (child > 0)
+        {
+            while ((waitpid(child, nullptr, 0) < 0) && (errno == EINTR))
+            {
+            }
+            // let signals still queued against the process drain
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        sigfn::reset(signum);
+        const std::size_t count = std::min(arrived.load(), iterations);
+        result.samples.reserve(count);
+        for (std::size_t index = 1; index < count; index++)
+        {
+            result.samples.push_back(bench_clock::duration(arrivals[index] - arrivals[index - 1]));
+        }
+        return result;
+    }
+
+#ifdef SIGRTMIN
+    // measures the time from thread_interrupter::interrupt() until a thread
+    // blocked in read() on an empty pipe is back in user code with EINTR. an
+    // interrupt that lands before read() blocks only sets the flag, so it is
+    // resent until the reader notices; the sample keeps the first send time
+    result interrupt_latency(const std::string &name, std::size_t iterations, int signum)
+    {
+        result result{name, {}};
+        sigfn::thread_interrupter interrupter(signum);
+        std::atomic<sigfn::thread_token> token(0);
+        std::atomic<bool> woken(false);
+        std::atomic<bench_clock::rep> sent(0);
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            return result;
+        }
+        result.samples.reserve(iterations);
+        std::thread reader(
+            [&]()
+            {
+                sigfn::interrupt_scope scope(interrupter);
+                char byte;
+                token = scope.token();
+                for (std::size_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    while (!scope.interrupted())
+                    {
+                        static_cast<void>(read(fds[0], &byte, 1));
+                    }
+                    const bench_clock::duration elapsed = bench_clock::now().time_since_epoch() - bench_clock::duration(sent.load());
+                    result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+                    scope.reset();
+                    woken = true;
+                }
+            });
+        while (token == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            // give the reader time to block again
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            sent = bench_clock::now().time_since_epoch().count();
+            bench_clock::time_point resent = bench_clock::now();
+            interrupter.interrupt(token);
+            while (!woken.exchange(false))
+            {
+                if (bench_clock::now() - resent > std::chrono::milliseconds(10))
+                {
+                    resent = bench_clock::now();
+                    interrupter.interrupt(token);
+                }
+                std::this_thread::yield();
+            }
+        }
+        reader.join();
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+#endif
+
+    // fixed CPU work per sample, with a profiler sampling at frequency Hz,
+    // or without one when frequency is 0
+    result profiled_work(const std::string &name, std::size_t iterations, unsigned int frequency)
+    {
+        result result{name, {}};
+        std::unique_ptr<sigfn::profiler> profiler;
+        volatile uint64_t sum(0);
+        if (frequency != 0)
+        {
+            profiler.reset(new sigfn::profiler(frequency));
+            profiler->start();
+        }
+        result.samples.reserve(iterations);
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            const bench_clock::time_point start = bench_clock::now();
+            for (uint64_t index = 0; index < 100000; index++)
+            {
+                sum = sum + index;
+            }
+            result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start));
+        }
+        return result;
+    }
+
+    // one write per sample, each under a suppress_sigpipe guard or with
+    // SIGPIPE ignored process-wide; a broken pipe fails every write with
+    // EPIPE, an open one is drained after each write
+    result sigpipe_write(const std::string &name, std::size_t iterations, bool guarded, bool broken)
+    {
+        result result{name, {}};
+        int fds[2];
+        const char byte('x');
+        char drained;
+        if (pipe(fds) != 0)
+        {
+            return result;
+        }
+        if (broken)
+        {
+            close(fds[0]);
+        }
+        if (!guarded)
+        {
+            sigfn::ignore(SIGPIPE);
+        }
+        result.samples.reserve(iterations);
+        for (std::size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            const bench_clock::time_point start = bench_clock::now();
+            if (guarded)
+            {
+                sigfn::suppress_sigpipe guard;
+                static_cast<void>(write(fds[1], &byte, 1));
+            }
+            else
+            {
+                static_cast<void>(write(fds[1], &byte, 1));
+            }
+            result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start));
+            if (!broken)
+            {
+                static_cast<void>(read(fds[0], &drained, 1));
+            }
+        }
+        if (!guarded)
+        {
+            sigfn::reset(SIGPIPE);
+        }
+        if (!broken)
+        {
+            close(fds[0]);
+        }
+        close(fds[1]);
+        return result;
+    }
+#endif
+}
+
+int main(int argc, const char **argv)
+{
+    std::size_t iterations(10000);
+    bool json(false);
+    std::vector<result> results;
+    for (int index = 1; index < argc; index++)
+    {
+        if (std::strcmp(argv[index], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (std::strcmp(argv[index], "--csv") == 0)
+        {
+            json = false;
+        }
+        else
+        {
+            iterations = std::stoul(argv[index]);
+        }
+    }
+
+    results.push_back(raise_latency(
+        "raise_handle_dynamic",
+        iterations,
+        SIGINT,
+        []()
+        {
+            sigfn::handle(
+                SIGINT,
+                [](int signum)
+                {
+                    record_handled(signum, nullptr);
+                });
+        }));
+    results.push_back(raise_latency(
+        "raise_handle_static",
+        iterations,
+        SIGINT,
+        []()
+        {
+            sigfn::handle<SIGINT>(
+                [](int signum)
+                {
+                    record_handled(signum, nullptr);
+                });
+        }));
+    results.push_back(raise_latency(
+        "raise_sigfn_handle",
+        iterations,
+        SIGINT,
+        []()
+        {
+            sigfn_handle(SIGINT, record_handled, nullptr);
+        }));
+
+    {
+        // three pointers of captured state, enough to spill out of the small
+        // buffer of a typical std::function
+        void *context[3] = {nullptr, nullptr, nullptr};
+        const auto handler = [context](int signum)
+        {
+            record_handled(signum, context[0]);
+        };
+        const sigfn::handler_function copied(handler);
+        results.push_back(registration_cost(
+            "register_handle_copy",
+            iterations,
+            SIGINT,
+            [&]()
+            {
+                sigfn::handle(SIGINT, copied);
+            }));
+        results.push_back(registration_cost(
+            "register_handle_move",
+            iterations,
+            SIGINT,
+            [&]()
+            {
+                sigfn::handle(SIGINT, sigfn::handler_function(handler));
+            }));
+        results.push_back(registration_cost(
+            "register_sigfn_handle",
+            iterations,
+            SIGINT,
+            []()
+            {
+                sigfn_handle(SIGINT, record_handled, nullptr);
+            }));
+    }
+
+    sigfn::watch(SIGINT);
+    results.push_back(check_cost(
+        "check_pending",
+        iterations,
+        SIGINT,
+        []()
+        {
+            return sigfn::pending(SIGINT);
+        }));
+    {
+        // the boilerplate sigfn::poll replaces: a handler that sets a flag
+        static std::atomic<bool> flag(false);
+        sigfn::handle(
+            SIGINT,
+            [](int)
+            {
+                flag.store(true, std::memory_order_relaxed);
+            });
+        results.push_back(check_cost(
+            "check_handler_flag",
+            iterations,
+            SIGINT,
+            []()
+            {
+                return flag.load(std::memory_order_relaxed);
+            }));
+    }
+
+#ifndef _WIN32
+    results.push_back(wakeup_latency(
+        "wait_legacy_promise",
+        iterations,
+        [](std::atomic<bool> &ready)
+        {
+            legacy_wait(SIGUSR1, ready);
+        }));
+    sigfn::reset(SIGUSR1);
+    {
+        // keep SIGUSR1 blocked between waits so an early signal stays pending
+        sigset_t blocked;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &blocked, nullptr);
+        results.push_back(wakeup_latency(
+            "wait_sigtimedwait",
+            iterations,
+            [](std::atomic<bool> &ready)
+            {
+                ready = true;
+                sigfn::wait({SIGUSR1});
+            }));
+        results.push_back(wakeup_latency(
+            "wait_for_sigtimedwait",
+            iterations,
+            [](std::atomic<bool> &ready)
+            {
+                ready = true;
+                sigfn::wait_for({SIGUSR1}, std::chrono::seconds(1));
+            }));
+        pthread_sigmask(SIG_UNBLOCK, &blocked, nullptr);
+    }
+
+    results.push_back(kill_storm("kill_storm_sigusr2", iterations, SIGUSR2));
+#ifdef SIGRTMIN
+    results.push_back(kill_storm("kill_storm_sigrtmin", iterations, SIGRTMIN));
+    results.push_back(interrupt_latency("interrupt_blocked_read", iterations, SIGRTMIN + 1));
+#endif
+    results.push_back(profiled_work("work_unprofiled", iterations, 0));
+    results.push_back(profiled_work("work_profiled_100hz", iterations, 100));
+    results.push_back(sigpipe_write("write_sigpipe_ignored", iterations, false, false));
+    results.push_back(sigpipe_write("write_sigpipe_guarded", iterations, true, false));
+    results.push_back(sigpipe_write("write_epipe_ignored", iterations, false, true));
+    results.push_back(sigpipe_write("write_epipe_guarded", iterations, true, true));
+#endif
+
+    if (json)
+    {
+        report_json(results);
+    }
+    else
+    {
+        report_csv(results);
+    }
+    return 0;
+}
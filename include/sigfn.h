@@ -47,6 +47,7 @@ extern "C"
     };
 #else
 #define DLL_EXPORT
+#include <sys/resource.h>
 #include <sys/time.h>
 #endif
 
@@ -58,6 +59,276 @@ extern "C"
      */
     typedef void (*sigfn_handler_func)(int signum, void *userdata);
 
+    /**
+     * @brief batched signal handler function type
+     *
+     * @param signum signal number
+     * @param count number of deliveries accumulated since the last batch
+     * @param userdata pointer to user defined data, can be NULL
+     */
+    typedef void (*sigfn_batch_func)(int signum, uint64_t count, void *userdata);
+
+/** restart interrupted system calls (SA_RESTART) */
+#define SIGFN_RESTART 0x1
+/** run on the alternate signal stack (SA_ONSTACK) */
+#define SIGFN_ONSTACK 0x2
+/** do not block the signal while its handler runs (SA_NODEFER) */
+#define SIGFN_NODEFER 0x4
+
+#ifndef _WIN32
+    /**
+     * @brief signal handler function type with delivery details
+     *
+     * @param info kernel supplied signal information, valid only during the call
+     * @param userdata pointer to user defined data, can be NULL
+     */
+    typedef void (*sigfn_info_handler_func)(const siginfo_t *info, void *userdata);
+#endif
+
+    /**
+     * @brief removal token of an attached handler
+     */
+    typedef uint64_t sigfn_token;
+
+    /**
+     * @brief opaque pollable signal source
+     */
+    typedef struct sigfn_event_source sigfn_event_source;
+
+/** thread pool priority for termination and other urgent handlers */
+#define SIGFN_PRIORITY_HIGH 0
+/** default thread pool priority */
+#define SIGFN_PRIORITY_NORMAL 1
+/** thread pool priority for bulk work */
+#define SIGFN_PRIORITY_LOW 2
+
+    /**
+     * @brief opaque stop request raised by a set of signals
+     */
+    typedef struct sigfn_stop_source sigfn_stop_source;
+
+    /**
+     * @brief callback function type without a signal number
+     *
+     * @param userdata pointer to user defined data, can be NULL
+     */
+    typedef void (*sigfn_callback_func)(void *userdata);
+
+    /**
+     * @brief opaque staged shutdown driven by termination signals
+     */
+    typedef struct sigfn_shutdown sigfn_shutdown;
+
+/** the drain function returned */
+#define SIGFN_SHUTDOWN_COMPLETED 0
+/** the drain function threw */
+#define SIGFN_SHUTDOWN_FAILED 1
+/** the drain function was still running at its deadline */
+#define SIGFN_SHUTDOWN_TIMED_OUT 2
+/** the stage never ran because the shutdown escalated */
+#define SIGFN_SHUTDOWN_SKIPPED 3
+/** size of the name of a shutdown timing, including the terminator */
+#define SIGFN_SHUTDOWN_NAME_MAX 64
+
+    /**
+     * @brief timing of one component of a shutdown
+     */
+    typedef struct sigfn_shutdown_timing
+    {
+        /** name given to sigfn_shutdown_add */
+        char name[SIGFN_SHUTDOWN_NAME_MAX];
+        /** stage given to sigfn_shutdown_add */
+        int stage;
+        /** SIGFN_SHUTDOWN_COMPLETED, FAILED, TIMED_OUT or SKIPPED */
+        int status;
+        /** time from the start of the stage until the drain returned or timed out */
+        uint64_t elapsed_ns;
+    } sigfn_shutdown_timing;
+
+    /**
+     * @brief opaque pool of worker threads for deferred handlers
+     */
+    typedef struct sigfn_thread_pool sigfn_thread_pool;
+
+#ifndef _WIN32
+    /**
+     * @brief single realtime signal delivery captured by a realtime queue
+     */
+    typedef struct sigfn_queued_signal
+    {
+        /** signal number */
+        int signum;
+        /** signal code, SI_QUEUE for sigqueue */
+        int code;
+        /** process id of the sender */
+        pid_t pid;
+        /** real user id of the sender */
+        uid_t uid;
+        /** value passed to sigqueue */
+        union sigval value;
+    } sigfn_queued_signal;
+
+    /**
+     * @brief opaque lossless realtime signal queue
+     */
+    typedef struct sigfn_realtime_queue sigfn_realtime_queue;
+
+    /**
+     * @brief exit of a child process reaped by a child watcher
+     */
+    typedef struct sigfn_child_exit
+    {
+        /** process id of the child */
+        pid_t pid;
+        /** CLD_EXITED, CLD_KILLED or CLD_DUMPED */
+        int code;
+        /** exit status for CLD_EXITED, otherwise the terminating signal */
+        int status;
+        /** resources used by the child */
+        struct rusage usage;
+    } sigfn_child_exit;
+
+    /**
+     * @brief child exit callback function type
+     *
+     * @param exit exit of the child
+     * @param userdata pointer to user defined data, can be NULL
+     */
+    typedef void (*sigfn_child_func)(const sigfn_child_exit *exit, void *userdata);
+
+    /**
+     * @brief opaque SIGCHLD reaper
+     */
+    typedef struct sigfn_child_watcher sigfn_child_watcher;
+
+    /**
+     * @brief identifier of a timer scheduled on a timer wheel
+     */
+    typedef uint64_t sigfn_timer_id;
+
+    /**
+     * @brief timer callback function type
+     *
+     * @param id timer that fired
+     * @param overruns number of periods missed since the previous call
+     * @param userdata pointer to user defined data, can be NULL
+     */
+    typedef void (*sigfn_timer_func)(sigfn_timer_id id, uint64_t overruns, void *userdata);
+
+    /**
+     * @brief opaque wheel of logical timers driven by one POSIX timer
+     */
+    typedef struct sigfn_timer_wheel sigfn_timer_wheel;
+
+    /**
+     * @brief identifier of a thread registered with a thread interrupter
+     */
+    typedef uint64_t sigfn_thread_token;
+
+    /**
+     * @brief opaque interrupter of blocked threads
+     */
+    typedef struct sigfn_thread_interrupter sigfn_thread_interrupter;
+
+    /**
+     * @brief opaque registration of a thread with a thread interrupter
+     */
+    typedef struct sigfn_interrupt_scope sigfn_interrupt_scope;
+
+    /**
+     * @brief opaque SIGPROF sampling profiler
+     */
+    typedef struct sigfn_profiler sigfn_profiler;
+
+    /**
+     * @brief state of a SIGPIPE suppression scope, see sigfn_sigpipe_suppress
+     */
+    typedef struct sigfn_sigpipe_guard
+    {
+        /** nonzero if an enclosing scope already blocks SIGPIPE */
+        int nested;
+        /** nonzero if SIGPIPE is unblocked when the scope ends */
+        int restore;
+        /** nonzero if a SIGPIPE was pending before the scope began */
+        int pending;
+    } sigfn_sigpipe_guard;
+#endif
+
+/** number of log2 buckets in the handler time histogram */
+#define SIGFN_HISTOGRAM_BUCKETS 32
+
+    /**
+     * @brief snapshot of the delivery counters kept for one signal
+     */
+    typedef struct sigfn_signal_stats
+    {
+        /** signal number */
+        int signum;
+        /** deliveries received by the sigfn signal handler */
+        uint64_t deliveries;
+        /** immediate, deferred and batched handler invocations */
+        uint64_t invocations;
+        /** total time spent in handlers in nanoseconds */
+        uint64_t handler_ns;
+        /** longest single handler invocation in nanoseconds */
+        uint64_t max_handler_ns;
+        /** deliveries folded into an already pending deferred run or batch */
+        uint64_t coalesced;
+        /** deliveries lost because no handler was installed or a realtime queue was full */
+        uint64_t dropped;
+        /** deliveries rejected or folded by a rate limit, throttle or debounce */
+        uint64_t suppressed;
+        /** handler times, bucket i counts invocations taking [2^i, 2^(i+1)) ns, except that bucket 0 also counts 0 ns and the last bucket has no upper bound */
+        uint64_t histogram[SIGFN_HISTOGRAM_BUCKETS];
+    } sigfn_signal_stats;
+
+#ifndef _WIN32
+/** trace dump as a sigfn_trace_header followed by sigfn_trace_event records */
+#define SIGFN_TRACE_BINARY 0
+/** trace dump in the Chrome trace event JSON format */
+#define SIGFN_TRACE_CHROME 1
+
+    /**
+     * @brief header at the start of a binary trace dump
+     */
+    typedef struct sigfn_trace_header
+    {
+        /** "SIGFNTRC" */
+        char magic[8];
+        /** format version, currently 1 */
+        uint32_t version;
+        /** size of each following sigfn_trace_event */
+        uint32_t event_size;
+        /** events lost because every per-thread ring was claimed */
+        uint64_t dropped;
+    } sigfn_trace_header;
+
+    /**
+     * @brief single record of a binary trace dump
+     *
+     * Timestamps are CLOCK_MONOTONIC nanoseconds, 0 when not applicable. A
+     * deferred signal produces one record for its delivery and one for the
+     * handler run on the dispatcher thread.
+     */
+    typedef struct sigfn_trace_event
+    {
+        /** signal number */
+        int32_t signum;
+        /** id of the thread that recorded the event */
+        int32_t tid;
+        /** process id of the sender, 0 if sent by the kernel */
+        int32_t sender;
+        /** always 0 */
+        int32_t reserved;
+        /** time the signal was delivered */
+        uint64_t delivered_ns;
+        /** time the handler was entered */
+        uint64_t entered_ns;
+        /** time the handler returned */
+        uint64_t exited_ns;
+    } sigfn_trace_event;
+#endif
+
     /**
      * @brief attach handler to specific signal
      *
@@ -68,6 +339,163 @@ extern "C"
      */
     DLL_EXPORT int sigfn_handle(int signum, sigfn_handler_func handler, void *userdata);
 
+#ifndef _WIN32
+    /**
+     * @brief attach handler that receives siginfo_t details to a specific signal
+     *
+     * Installed with sigaction and SA_SIGINFO. The info is passed straight
+     * from the kernel frame, without copies or allocations.
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @param flags bitwise OR of SIGFN_RESTART, SIGFN_ONSTACK and SIGFN_NODEFER
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_handle_info(int signum, sigfn_info_handler_func handler, void *userdata, int flags);
+#endif
+
+    /**
+     * @brief attach handler to run on the sigfn dispatcher thread
+     *
+     * The handler runs outside of signal context, so it may allocate, lock
+     * or log. Deliveries that arrive before the dispatcher runs are
+     * coalesced into a single call.
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_defer(int signum, sigfn_handler_func handler, void *userdata);
+
+    /**
+     * @brief add handler to the chain of a specific signal
+     *
+     * Unlike sigfn_handle, attaching never replaces another handler.
+     * Attached handlers run in the order they were attached, before the
+     * handler installed with sigfn_handle or sigfn_defer.
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @param token receives the token that detaches the handler, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_attach(int signum, sigfn_handler_func handler, void *userdata, sigfn_token *token);
+
+    /**
+     * @brief add handler to the chain of a specific signal to run on the sigfn dispatcher thread
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @param token receives the token that detaches the handler, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_attach_deferred(int signum, sigfn_handler_func handler, void *userdata, sigfn_token *token);
+
+    /**
+     * @brief remove an attached handler
+     *
+     * The signal is reset to its default behavior when its last handler is
+     * removed.
+     *
+     * @param token token returned by sigfn_attach or sigfn_attach_deferred
+     * @returns 0 on success, -1 on error, 1 if the handler was already removed
+     */
+    DLL_EXPORT int sigfn_detach(sigfn_token token);
+
+    /**
+     * @brief start a pool of worker threads
+     *
+     * @param workers number of worker threads, at least one
+     * @param pool receives the new pool
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_thread_pool_create(size_t workers, sigfn_thread_pool **pool);
+
+    /**
+     * @brief attach handler to run on a thread pool instead of the dispatcher thread
+     *
+     * The handler never runs concurrently with itself. Deliveries that
+     * arrive while it is queued or running are coalesced into one more call.
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @param pool pool that runs the handler
+     * @param priority SIGFN_PRIORITY_HIGH, SIGFN_PRIORITY_NORMAL or SIGFN_PRIORITY_LOW
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_defer_pool(int signum, sigfn_handler_func handler, void *userdata, sigfn_thread_pool *pool, int priority);
+
+    /**
+     * @brief reset the signals deferred to the pool, run its queued work and join its workers
+     *
+     * @param pool thread pool, can be NULL
+     */
+    DLL_EXPORT void sigfn_thread_pool_destroy(sigfn_thread_pool *pool);
+
+    /**
+     * @brief accumulate deliveries and run a batched handler on the dispatcher thread
+     *
+     * Each delivery only increments an atomic counter. The handler runs
+     * once per batch, when the window elapses or the threshold is reached.
+     *
+     * @param signum signal to be handled
+     * @param handler function associated with this signal
+     * @param userdata optional user data passed to the function
+     * @param window maximum time to hold a batch, NULL flushes on the next dispatcher cycle
+     * @param threshold number of deliveries that flushes a batch early, 0 disables it
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_coalesce(int signum, sigfn_batch_func handler, void *userdata, const struct timeval *window, uint64_t threshold);
+
+    /**
+     * @brief limit the deliveries of a signal with a token bucket
+     *
+     * Deliveries beyond the rate and burst are suppressed in the signal
+     * handler, before any registered handler runs, and counted in
+     * sigfn_signal_stats.suppressed.
+     *
+     * @param signum signal to limit
+     * @param rate sustained deliveries per second, at most 1e9 and at least
+     * about 1.1e-10 so that one interval fits in a signed 64-bit nanosecond count
+     * @param burst deliveries allowed back to back, at least 1
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_rate_limit(int signum, double rate, uint64_t burst);
+
+    /**
+     * @brief pass the first delivery of a signal and suppress the rest for an interval
+     *
+     * @param signum signal to limit
+     * @param interval time during which further deliveries are suppressed
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_throttle(int signum, const struct timeval *interval);
+
+    /**
+     * @brief hold deliveries of a signal until it has been quiet for an interval
+     *
+     * A burst of deliveries produces a single trailing delivery, run on
+     * the dispatcher thread.
+     *
+     * @param signum signal to limit
+     * @param interval quiet time that ends a burst
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_debounce(int signum, const struct timeval *interval);
+
+    /**
+     * @brief remove the rate limit, throttle or debounce of a signal
+     *
+     * @param signum signal to unlimit
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_unlimit(int signum);
+
     /**
      * @brief ignore a specific signal
      *
@@ -84,9 +512,45 @@ extern "C"
      */
     DLL_EXPORT int sigfn_reset(int signum);
 
+/** bit that represents a signal in the mask returned by sigfn_poll */
+#define SIGFN_SIGNAL_BIT(signum) (((signum) > 0 && (signum) <= 64) ? ((uint64_t)1 << ((signum) - 1)) : (uint64_t)0)
+
+    /**
+     * @brief record deliveries of a specific signal for polling
+     *
+     * Replaces the handler of the signal. A delivery only sets the bit of
+     * the signal in a process-wide atomic bitmap, which sigfn_poll and
+     * sigfn_pending read without a syscall.
+     *
+     * @param signum signal to watch
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_watch(int signum);
+
+    /**
+     * @brief fetch and clear the watched signals delivered since the last poll
+     *
+     * @returns mask of SIGFN_SIGNAL_BIT values
+     */
+    DLL_EXPORT uint64_t sigfn_poll();
+
+    /**
+     * @brief check whether a watched signal was delivered since the last poll
+     *
+     * Costs a single relaxed load and does not clear the signal.
+     *
+     * @param signum signal number
+     * @returns 1 if the signal is pending, 0 otherwise
+     */
+    DLL_EXPORT int sigfn_pending(int signum);
+
     /**
      * @brief wait for any of the specified signals
      *
+     * The signals are blocked in the calling thread for the duration of the
+     * wait, so registered handlers are left in place. Other threads should
+     * keep these signals blocked.
+     *
      * @param signums array of signal numbers
      * @param count number of signals in the array
      * @param received signal number that was received, can be NULL
@@ -116,6 +580,549 @@ extern "C"
      */
     DLL_EXPORT int sigfn_wait_until(const int *signums, size_t count, int *received, const struct timeval *deadline);
 
+    /**
+     * @brief create a stop request raised by any of the specified signals
+     *
+     * Handlers are attached to the signals with sigfn_attach, so other
+     * handlers of these signals are left in place.
+     *
+     * @param signums array of signal numbers, SIGINT and SIGTERM for example
+     * @param count number of signals in the array
+     * @param source receives the new source
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_stop_source_create(const int *signums, size_t count, sigfn_stop_source **source);
+
+    /**
+     * @brief check whether a stop was requested, a single atomic load
+     *
+     * @param source stop source
+     * @returns 1 if a stop was requested, 0 otherwise
+     */
+    DLL_EXPORT int sigfn_stop_requested(const sigfn_stop_source *source);
+
+    /**
+     * @brief request a stop without a signal
+     *
+     * @param source stop source
+     * @returns 0 on success, -1 on error, 1 if a stop was already requested
+     */
+    DLL_EXPORT int sigfn_stop_request(sigfn_stop_source *source);
+
+    /**
+     * @brief wait for any of the specified signals until a stop is requested
+     *
+     * @param signums array of signal numbers
+     * @param count number of signals in the array
+     * @param received signal number that was received, can be NULL
+     * @param source stop source that interrupts the wait
+     * @returns 0 on success, -1 on error, 1 if a stop was requested
+     */
+    DLL_EXPORT int sigfn_wait_stoppable(const int *signums, size_t count, int *received, const sigfn_stop_source *source);
+
+    /**
+     * @brief detach the stop handlers and free the source
+     *
+     * @param source stop source, can be NULL
+     */
+    DLL_EXPORT void sigfn_stop_source_destroy(sigfn_stop_source *source);
+
+    /**
+     * @brief create a staged shutdown driven by termination signals
+     *
+     * The first termination signal releases sigfn_shutdown_wait, which
+     * drains the stages in ascending order, the components of a stage in
+     * parallel. A second termination signal, or a component still running
+     * at its deadline, runs the escalation function.
+     *
+     * @param signums array of termination signals
+     * @param count number of signals in the array
+     * @param escalate function invoked on escalation, NULL for _Exit(EXIT_FAILURE)
+     * @param userdata optional user data passed to the escalation function
+     * @param shutdown receives the new shutdown
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_shutdown_create(const int *signums, size_t count, sigfn_callback_func escalate, void *userdata, sigfn_shutdown **shutdown);
+
+    /**
+     * @brief register a component
+     *
+     * @param shutdown shutdown
+     * @param name name reported in the timings, truncated to SIGFN_SHUTDOWN_NAME_MAX - 1 characters
+     * @param stage stages drain in ascending order
+     * @param timeout time the drain may take before the shutdown escalates
+     * @param drain function that tears the component down
+     * @param userdata optional user data passed to the drain function
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_shutdown_add(sigfn_shutdown *shutdown, const char *name, int stage, const struct timeval *timeout, sigfn_callback_func drain, void *userdata);
+
+    /**
+     * @brief block until the first termination signal, then drain every stage
+     *
+     * @param shutdown shutdown
+     * @param timings receives the timing of each component in stage order, can be NULL if max is 0
+     * @param max capacity of the timings array
+     * @param count number of timings written, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_shutdown_wait(sigfn_shutdown *shutdown, sigfn_shutdown_timing *timings, size_t max, size_t *count);
+
+    /**
+     * @brief drain every stage now, once
+     *
+     * @param shutdown shutdown
+     * @param timings receives the timing of each component in stage order, can be NULL if max is 0
+     * @param max capacity of the timings array
+     * @param count number of timings written, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_shutdown_run(sigfn_shutdown *shutdown, sigfn_shutdown_timing *timings, size_t max, size_t *count);
+
+    /**
+     * @brief detach the termination handlers and free the shutdown
+     *
+     * @param shutdown shutdown, can be NULL
+     */
+    DLL_EXPORT void sigfn_shutdown_destroy(sigfn_shutdown *shutdown);
+
+    /**
+     * @brief block signals in the calling thread and open a pollable source
+     *
+     * The returned source exposes a file descriptor that can be registered
+     * with epoll, poll or select. Requires signalfd (Linux).
+     *
+     * @param signums array of signal numbers
+     * @param count number of signals in the array
+     * @param source receives the new source
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_event_source_create(const int *signums, size_t count, sigfn_event_source **source);
+
+    /**
+     * @brief get the pollable file descriptor of a source
+     *
+     * @param source event source
+     * @returns file descriptor, -1 on error
+     */
+    DLL_EXPORT int sigfn_event_source_fd(const sigfn_event_source *source);
+
+    /**
+     * @brief drain pending signals and invoke their registered handlers
+     *
+     * @param source event source
+     * @param dispatched number of signals drained, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_event_source_dispatch(sigfn_event_source *source, size_t *dispatched);
+
+    /**
+     * @brief close a source and unblock its signals in the calling thread
+     *
+     * Only the signals the creating thread had not already blocked are
+     * unblocked.
+     *
+     * @param source event source, can be NULL
+     */
+    DLL_EXPORT void sigfn_event_source_destroy(sigfn_event_source *source);
+
+#ifndef _WIN32
+    /**
+     * @brief capture every delivery of the given realtime signals
+     *
+     * Deliveries are pushed from the signal handler into a preallocated
+     * lock-free ring along with their sigqueue payload and sender.
+     *
+     * @param signums array of realtime signal numbers
+     * @param count number of signals in the array
+     * @param capacity minimum number of buffered deliveries, rounded up to a power of two
+     * @param queue receives the new queue
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_realtime_queue_create(const int *signums, size_t count, size_t capacity, sigfn_realtime_queue **queue);
+
+    /**
+     * @brief move buffered deliveries out of the queue in arrival order
+     *
+     * @param queue realtime queue
+     * @param signals destination array
+     * @param max capacity of the destination array
+     * @param drained number of deliveries written, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_realtime_queue_drain(sigfn_realtime_queue *queue, sigfn_queued_signal *signals, size_t max, size_t *drained);
+
+    /**
+     * @brief number of deliveries lost because the queue was full
+     *
+     * @param queue realtime queue
+     * @returns overflow count, 0 if queue is NULL
+     */
+    DLL_EXPORT uint64_t sigfn_realtime_queue_overflows(const sigfn_realtime_queue *queue);
+
+    /**
+     * @brief give the captured signals back to their previous handlers and free the queue
+     *
+     * A signal that was at its default action keeps an empty sigfn handler,
+     * so a delivery still queued for it is dropped instead of terminating
+     * the process.
+     *
+     * @param queue realtime queue, can be NULL
+     */
+    DLL_EXPORT void sigfn_realtime_queue_destroy(sigfn_realtime_queue *queue);
+
+    /**
+     * @brief reap children in batches on SIGCHLD and report their exits
+     *
+     * Children are tracked with pidfds where the kernel supports them,
+     * otherwise every child of the process is reaped with wait4, including
+     * those of system() or popen(), whose callers then lose the exit status.
+     * Exits of children not watched yet are kept for a later watch, up to
+     * the 1024 most recent. Only one watcher should exist per process.
+     *
+     * @param watcher receives the new watcher
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_child_watcher_create(sigfn_child_watcher **watcher);
+
+    /**
+     * @brief invoke a callback when a child exits
+     *
+     * A child that already exited is reaped at once and its callback runs
+     * in the calling thread; otherwise it runs on the dispatcher thread.
+     *
+     * @param watcher child watcher
+     * @param pid process id of a child of this process
+     * @param callback function invoked with the exit of the child
+     * @param userdata optional user data passed to the callback
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_child_watch(sigfn_child_watcher *watcher, pid_t pid, sigfn_child_func callback, void *userdata);
+
+    /**
+     * @brief stop watching a child without reaping it
+     *
+     * @param watcher child watcher
+     * @param pid process id of the child
+     * @returns 0 if the child was watched, 1 if it was not, -1 on error
+     */
+    DLL_EXPORT int sigfn_child_unwatch(sigfn_child_watcher *watcher, pid_t pid);
+
+    /**
+     * @brief reap exited children and invoke their callbacks now
+     *
+     * @param watcher child watcher
+     * @param reaped number of callbacks invoked, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_child_reap(sigfn_child_watcher *watcher, size_t *reaped);
+
+    /**
+     * @brief detach the SIGCHLD handler and free the watcher
+     *
+     * @param watcher child watcher, can be NULL
+     */
+    DLL_EXPORT void sigfn_child_watcher_destroy(sigfn_child_watcher *watcher);
+
+    /**
+     * @brief multiplex logical timers onto one POSIX timer
+     *
+     * The kernel timer delivers a realtime signal, reserved for the wheel,
+     * and callbacks run on the dispatcher thread.
+     *
+     * @param signum realtime signal delivered by the kernel timer
+     * @param tick resolution of the wheel
+     * @param wheel receives the new wheel
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_timer_wheel_create(int signum, const struct timeval *tick, sigfn_timer_wheel **wheel);
+
+    /**
+     * @brief schedule a timer
+     *
+     * @param wheel timer wheel
+     * @param after time until the first expiration
+     * @param period time between expirations, NULL for a one-shot timer
+     * @param callback function invoked when the timer fires
+     * @param userdata optional user data passed to the callback
+     * @param id receives the identifier of the timer, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_timer_schedule(sigfn_timer_wheel *wheel, const struct timeval *after, const struct timeval *period, sigfn_timer_func callback, void *userdata, sigfn_timer_id *id);
+
+    /**
+     * @brief cancel a timer
+     *
+     * @param wheel timer wheel
+     * @param id identifier of the timer
+     * @returns 0 if the timer was cancelled, 1 if it already fired or was cancelled, -1 on error
+     */
+    DLL_EXPORT int sigfn_timer_cancel(sigfn_timer_wheel *wheel, sigfn_timer_id id);
+
+    /**
+     * @brief delete the kernel timer, give its signal back to the previous handler and free the wheel
+     *
+     * A signal that was at its default action keeps an empty sigfn handler,
+     * so an expiry still queued for it is dropped instead of terminating the
+     * process.
+     *
+     * @param wheel timer wheel, can be NULL
+     */
+    DLL_EXPORT void sigfn_timer_wheel_destroy(sigfn_timer_wheel *wheel);
+
+    /**
+     * @brief reserve a realtime signal for interrupting blocked threads
+     *
+     * The signal is installed without SA_RESTART, so blocking calls in an
+     * interrupted thread fail with EINTR.
+     *
+     * @param signum realtime signal reserved for interruptions
+     * @param interrupter receives the new interrupter
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_thread_interrupter_create(int signum, sigfn_thread_interrupter **interrupter);
+
+    /**
+     * @brief set the interrupt flag of a thread and signal it
+     *
+     * @param interrupter thread interrupter
+     * @param token token of a registered thread
+     * @returns 0 if the thread was signalled, 1 if it is not registered, -1 on error
+     */
+    DLL_EXPORT int sigfn_thread_interrupt(sigfn_thread_interrupter *interrupter, sigfn_thread_token token);
+
+    /**
+     * @brief give the reserved signal back to its previous handler and free the interrupter
+     *
+     * A signal that was at its default action keeps an empty sigfn handler,
+     * so an interruption still queued for it is dropped instead of
+     * terminating the process.
+     *
+     * @param interrupter thread interrupter, can be NULL
+     */
+    DLL_EXPORT void sigfn_thread_interrupter_destroy(sigfn_thread_interrupter *interrupter);
+
+    /**
+     * @brief register the calling thread with an interrupter
+     *
+     * @param interrupter thread interrupter
+     * @param callback optional function run in this thread, in signal context, on each interruption
+     * @param userdata optional user data passed to the callback
+     * @param token receives the token other threads pass to sigfn_thread_interrupt, can be NULL
+     * @param scope receives the new registration
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_interrupt_enter(sigfn_thread_interrupter *interrupter, sigfn_handler_func callback, void *userdata, sigfn_thread_token *token, sigfn_interrupt_scope **scope);
+
+    /**
+     * @brief check whether the registered thread was interrupted
+     *
+     * @param scope registration of the calling thread
+     * @returns 1 if interrupted, 0 if not or if scope is NULL
+     */
+    DLL_EXPORT int sigfn_interrupted(const sigfn_interrupt_scope *scope);
+
+    /**
+     * @brief clear the interrupt flag of the registered thread
+     *
+     * @param scope registration of the calling thread
+     * @returns 1 if the flag was set, 0 if it was not, -1 on error
+     */
+    DLL_EXPORT int sigfn_interrupt_reset(sigfn_interrupt_scope *scope);
+
+    /**
+     * @brief unregister the calling thread and free the registration
+     *
+     * @param scope registration of the calling thread, can be NULL
+     */
+    DLL_EXPORT void sigfn_interrupt_leave(sigfn_interrupt_scope *scope);
+#endif
+
+    /**
+     * @brief read the delivery counters of a signal without blocking delivery
+     *
+     * Counters are read one at a time, so a snapshot taken while the signal
+     * is firing may be off by the deliveries that raced with it.
+     *
+     * @param signum signal number
+     * @param stats destination for the snapshot
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_stats(int signum, sigfn_signal_stats *stats);
+
+    /**
+     * @brief zero the delivery counters of every signal
+     *
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_stats_reset();
+
+#ifndef _WIN32
+    /**
+     * @brief start recording deliveries and handler runs into per-thread rings
+     *
+     * The rings are allocated by the first call and reused afterwards, so
+     * later calls only resume recording. Recording is wait-free and each
+     * ring keeps the most recent events.
+     *
+     * @param threads number of threads that can record events
+     * @param capacity events kept per thread, rounded up to a power of two
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_trace_start(size_t threads, size_t capacity);
+
+    /**
+     * @brief stop recording, recorded events are kept
+     *
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_trace_stop();
+
+    /**
+     * @brief write the recorded events to a file descriptor
+     *
+     * Only async-signal-safe calls are made, so this can run in a handler.
+     *
+     * @param fd destination file descriptor
+     * @param format SIGFN_TRACE_BINARY or SIGFN_TRACE_CHROME
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_trace_dump(int fd, int format);
+
+    /**
+     * @brief dump the recorded events whenever a signal is received
+     *
+     * The dump is attached, so other handlers of the signal keep running.
+     *
+     * @param signum signal that triggers the dump, typically SIGUSR2
+     * @param fd destination file descriptor
+     * @param format SIGFN_TRACE_BINARY or SIGFN_TRACE_CHROME
+     * @param token receives the token for sigfn_detach, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_trace_dump_on(int signum, int fd, int format, sigfn_token *token);
+
+    /**
+     * @brief report fatal signals to a file descriptor
+     *
+     * On a fatal signal the signal, fault address, registers and a
+     * backtrace are written to the descriptor with async-signal-safe calls
+     * only. Then the previous handler is reinstalled and gets the signal,
+     * so a handler that recovers keeps the process alive; without one the
+     * signal is raised again with SIG_DFL. Also gives the calling thread an
+     * alternate signal stack.
+     *
+     * @param fd pre-opened destination file descriptor
+     * @param signums array of signals to report, NULL for SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT
+     * @param count number of signals in the array
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_crash_install(int fd, const int *signums, size_t count);
+
+    /**
+     * @brief give the calling thread an alternate signal stack
+     *
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_crash_thread_init();
+
+    /**
+     * @brief restore the dispositions replaced by sigfn_crash_install
+     *
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_crash_uninstall();
+
+    /**
+     * @brief create a sampling CPU profiler driven by SIGPROF
+     *
+     * Stacks are recorded in signal context into per-thread rings without
+     * allocating, and aggregated on the sigfn dispatcher thread.
+     *
+     * @param frequency samples per second of CPU time
+     * @param threads number of threads that can record samples
+     * @param capacity samples buffered per thread, rounded up to a power of two
+     * @param profiler receives the new profiler
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_create(unsigned int frequency, size_t threads, size_t capacity, sigfn_profiler **profiler);
+
+    /**
+     * @brief take over SIGPROF and arm the interval timer, only one profiler can run at a time
+     *
+     * @param profiler profiler
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_start(sigfn_profiler *profiler);
+
+    /**
+     * @brief disarm the interval timer, aggregated samples are kept
+     *
+     * SIGPROF goes back to its previous handler. If it was at its default
+     * action, an empty sigfn handler stays, so a sample still pending is
+     * dropped instead of terminating the process.
+     *
+     * @param profiler profiler
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_stop(sigfn_profiler *profiler);
+
+    /**
+     * @brief get the sample counters
+     *
+     * @param profiler profiler
+     * @param samples receives the number of samples recorded, can be NULL
+     * @param dropped receives the number of samples lost, can be NULL
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_counts(sigfn_profiler *profiler, uint64_t *samples, uint64_t *dropped);
+
+    /**
+     * @brief write the aggregated stacks in the folded flamegraph format
+     *
+     * @param profiler profiler
+     * @param fd destination file descriptor
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_dump(sigfn_profiler *profiler, int fd);
+
+    /**
+     * @brief discard the aggregated stacks and counters
+     *
+     * @param profiler profiler
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_profiler_clear(sigfn_profiler *profiler);
+
+    /**
+     * @brief stop sampling and free the profiler
+     *
+     * @param profiler profiler, can be NULL
+     */
+    DLL_EXPORT void sigfn_profiler_destroy(sigfn_profiler *profiler);
+
+    /**
+     * @brief block SIGPIPE on the calling thread until sigfn_sigpipe_restore
+     *
+     * Writes to a closed pipe or socket fail with EPIPE instead of
+     * terminating the process, without changing the process-wide
+     * disposition. Scopes nest and must end in reverse order on the thread
+     * that began them.
+     *
+     * @param guard receives the scope state
+     * @returns 0 on success, -1 on error
+     */
+    DLL_EXPORT int sigfn_sigpipe_suppress(sigfn_sigpipe_guard *guard);
+
+    /**
+     * @brief consume a SIGPIPE raised in the scope and restore the mask
+     *
+     * @param guard scope state filled by sigfn_sigpipe_suppress
+     * @returns 0 if nothing was consumed, 1 if a SIGPIPE was consumed, -1 on error
+     */
+    DLL_EXPORT int sigfn_sigpipe_restore(sigfn_sigpipe_guard *guard);
+#endif
+
     /**
      * @brief get the last error message
      *
@@ -31,29 +31,233 @@
 
 #include <csignal>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #define DLL_EXPORT __declspec(dllexport)
 #else
 #define DLL_EXPORT
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#endif
+
+#if defined(SIGFN_COROUTINES) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+#ifndef SIGFN_INLINE_CAPACITY
+#define SIGFN_INLINE_CAPACITY 64
 #endif
 
 namespace sigfn
 {
+    template <class Signature, std::size_t Capacity = SIGFN_INLINE_CAPACITY>
+    class inplace_function;
+
+    /**
+     * @brief fixed-capacity callable wrapper that never allocates
+     *
+     * Behaves like std::function, but the callable is stored in an inline
+     * buffer of Capacity bytes. Callables that do not fit are rejected at
+     * compile time instead of spilling to the heap.
+     *
+     * @tparam R return type
+     * @tparam Args argument types
+     * @tparam Capacity size of the inline buffer in bytes
+     */
+    template <class R, class... Args, std::size_t Capacity>
+    class inplace_function<R(Args...), Capacity>
+    {
+    public:
+        /**
+         * @brief construct an empty function
+         */
+        inplace_function() noexcept : _operations(nullptr)
+        {
+        }
+
+        /**
+         * @brief construct an empty function
+         */
+        inplace_function(std::nullptr_t) noexcept : _operations(nullptr)
+        {
+        }
+
+        /**
+         * @brief store a callable in the inline buffer
+         *
+         * Null function pointers and empty std::function objects produce an
+         * empty inplace_function.
+         *
+         * @param callable function object to store
+         */
+        template <
+            class F,
+            class = std::enable_if_t<
+                !std::is_same_v<std::decay_t<F>, inplace_function> &&
+                std::is_invocable_r_v<R, std::decay_t<F> &, Args...>>>
+        inplace_function(F &&callable) : _operations(nullptr)
+        {
+            typedef std::decay_t<F> callable_type;
+            static_assert(sizeof(callable_type) <= Capacity, "sigfn: callable exceeds inplace_function capacity");
+            static_assert(alignof(callable_type) <= alignof(std::max_align_t), "sigfn: callable is over-aligned");
+            static_assert(std::is_copy_constructible_v<callable_type>, "sigfn: callable must be copy constructible");
+            if constexpr (std::is_constructible_v<bool, const callable_type &>)
+            {
+                if (!static_cast<bool>(callable))
+                {
+                    return;
+                }
+            }
+            ::new (static_cast<void *>(&_storage)) callable_type(std::forward<F>(callable));
+            _operations = &operations_for<callable_type>;
+        }
+
+        inplace_function(const inplace_function &other) : _operations(other._operations)
+        {
+            if (_operations != nullptr)
+            {
+                _operations->copy(&_storage, &other._storage);
+            }
+        }
+
+        inplace_function(inplace_function &&other) noexcept : _operations(other._operations)
+        {
+            if (_operations != nullptr)
+            {
+                _operations->move(&_storage, &other._storage);
+            }
+        }
+
+        ~inplace_function()
+        {
+            reset();
+        }
+
+        inplace_function &operator=(const inplace_function &other)
+        {
+            if (this != &other)
+            {
+                reset();
+                if (other._operations != nullptr)
+                {
+                    other._operations->copy(&_storage, &other._storage);
+                    _operations = other._operations;
+                }
+            }
+            return *this;
+        }
+
+        inplace_function &operator=(inplace_function &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                if (other._operations != nullptr)
+                {
+                    other._operations->move(&_storage, &other._storage);
+                    _operations = other._operations;
+                }
+            }
+            return *this;
+        }
+
+        /**
+         * @brief check whether a callable is stored
+         */
+        explicit operator bool() const noexcept
+        {
+            return _operations != nullptr;
+        }
+
+        /**
+         * @brief invoke the stored callable
+         *
+         * @param args arguments forwarded to the callable
+         * @return result of the callable
+         */
+        R operator()(Args... args) const
+        {
+            if (_operations == nullptr)
+            {
+                throw std::bad_function_call();
+            }
+            return _operations->invoke(const_cast<void *>(static_cast<const void *>(&_storage)), std::forward<Args>(args)...);
+        }
+
+    private:
+        struct operations
+        {
+            R (*invoke)(void *, Args &&...);
+            void (*copy)(void *, const void *);
+            void (*move)(void *, void *);
+            void (*destroy)(void *);
+        };
+
+        template <class T>
+        static constexpr operations operations_for = {
+            [](void *callable, Args &&...args) -> R
+            {
+                return (*static_cast<T *>(callable))(std::forward<Args>(args)...);
+            },
+            [](void *destination, const void *source)
+            {
+                ::new (destination) T(*static_cast<const T *>(source));
+            },
+            [](void *destination, void *source)
+            {
+                ::new (destination) T(std::move(*static_cast<T *>(source)));
+            },
+            [](void *callable)
+            {
+                static_cast<T *>(callable)->~T();
+            }};
+
+        void reset() noexcept
+        {
+            if (_operations != nullptr)
+            {
+                _operations->destroy(&_storage);
+                _operations = nullptr;
+            }
+        }
+
+        std::aligned_storage_t<Capacity, alignof(std::max_align_t)> _storage;
+        const operations *_operations;
+    };
+
+#ifdef SIGFN_NO_HEAP
+    /**
+     * @brief signal handler function object type
+     *
+     * @param signum signal number
+     */
+    typedef inplace_function<void(int)> handler_function;
+#else
     /**
      * @brief signal handler function object type
      *
      * @param signum signal number
      */
     typedef std::function<void(int)> handler_function;
+#endif
 
     /**
      * @brief attach handler to specific signal using copy semantics
@@ -71,6 +275,516 @@ namespace sigfn
      */
     DLL_EXPORT void handle(int signum, handler_function &&handler_function);
 
+    namespace internal
+    {
+        /**
+         * @brief install a raw handler for a signal, bypassing the dispatch table
+         *
+         * @param signum signal to be handled
+         * @param trampoline function the kernel will call on delivery
+         */
+        DLL_EXPORT void attach_static(int signum, void (*trampoline)(int));
+
+        // Static storage for one callable type per signal. Two buffers are
+        // alternated and every delivery counts itself into the buffer it
+        // runs, so a registration only destroys the inactive buffer once the
+        // deliveries still running it have returned. Registrations are
+        // serialized, so concurrent callers cannot flip the buffers under
+        // each other. A handler must not register its own signal twice
+        // during one delivery, the second registration would wait for it.
+        template <int Signum, class F>
+        class static_slot
+        {
+        public:
+            template <class G>
+            static void emplace(G &&callable)
+            {
+                const std::lock_guard<std::mutex> lock(_mutex);
+                const int next = 1 - _active.load();
+                if (_constructed[next].load())
+                {
+                    while (_running[next].load() != 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    get(next).~F();
+                    _constructed[next].store(false);
+                }
+                ::new (static_cast<void *>(&_storage[next])) F(std::forward<G>(callable));
+                _constructed[next].store(true);
+                _active.store(next);
+            }
+
+            static void trampoline(int signum)
+            {
+                // counted before the buffer is checked again, so emplace
+                // either sees the count or this delivery sees the switch
+                int index = _active.load();
+                _running[index].fetch_add(1);
+                while (index != _active.load())
+                {
+                    _running[index].fetch_sub(1);
+                    index = _active.load();
+                    _running[index].fetch_add(1);
+                }
+                const running_guard guard{_running[index]};
+                F &callable = get(index);
+                if constexpr (std::is_invocable_v<F &, int>)
+                {
+                    callable(signum);
+                }
+                else
+                {
+                    callable();
+                }
+            }
+
+        private:
+            struct running_guard
+            {
+                std::atomic<unsigned int> &count;
+
+                ~running_guard()
+                {
+                    count.fetch_sub(1);
+                }
+            };
+
+            static F &get(int index)
+            {
+                return *std::launder(reinterpret_cast<F *>(&_storage[index]));
+            }
+
+            static inline std::aligned_storage_t<sizeof(F), alignof(F)> _storage[2];
+            static inline std::atomic<bool> _constructed[2] = {false, false};
+            static inline std::atomic<int> _active{0};
+            static inline std::atomic<unsigned int> _running[2] = {0, 0};
+            static inline std::mutex _mutex;
+        };
+    }
+
+    /**
+     * @brief attach a handler specialized for one signal at compile time
+     *
+     * The callable is stored in static storage and the kernel calls a
+     * trampoline generated for this signal and callable type, so delivery
+     * involves no table lookup, no type erasure and no heap allocation, and
+     * the callable can be inlined into the trampoline. The callable may
+     * take the signal number or no arguments. Registering a dynamic handler
+     * for the same signal later replaces it.
+     *
+     * @tparam Signum signal to be handled
+     * @param callable function object associated with this signal
+     */
+    template <int Signum, class F>
+    void handle(F &&callable)
+    {
+        typedef std::decay_t<F> callable_type;
+        static_assert(Signum > 0 && Signum < NSIG, "sigfn: invalid signal number");
+        static_assert(
+            std::is_invocable_v<callable_type &, int> || std::is_invocable_v<callable_type &>,
+            "sigfn: handler must be callable with a signal number or no arguments");
+        internal::static_slot<Signum, callable_type>::emplace(std::forward<F>(callable));
+        internal::attach_static(Signum, &internal::static_slot<Signum, callable_type>::trampoline);
+    }
+
+    /**
+     * @brief sigaction flags for handle_info
+     */
+    enum flags : int
+    {
+        /// restart interrupted system calls (SA_RESTART)
+        restart = 0x1,
+        /// run on the alternate signal stack (SA_ONSTACK)
+        onstack = 0x2,
+        /// do not block the signal while its handler runs (SA_NODEFER)
+        nodefer = 0x4
+    };
+
+#ifndef _WIN32
+    /**
+     * @brief view of the kernel supplied siginfo_t for a single delivery
+     *
+     * Refers to the frame passed to the signal handler, so it must not
+     * outlive the handler invocation.
+     */
+    class signal_info
+    {
+    public:
+        /**
+         * @brief wrap a native siginfo_t without copying it
+         *
+         * @param info native signal information
+         */
+        explicit signal_info(const siginfo_t &info) : _info(info)
+        {
+        }
+
+        /**
+         * @brief signal number
+         */
+        int signum() const
+        {
+            return _info.si_signo;
+        }
+
+        /**
+         * @brief signal code, such as SI_USER, SI_QUEUE or CLD_EXITED
+         */
+        int code() const
+        {
+            return _info.si_code;
+        }
+
+        /**
+         * @brief process id of the sender
+         */
+        pid_t pid() const
+        {
+            return _info.si_pid;
+        }
+
+        /**
+         * @brief real user id of the sender
+         */
+        uid_t uid() const
+        {
+            return _info.si_uid;
+        }
+
+        /**
+         * @brief exit value or signal of a child, valid for SIGCHLD
+         */
+        int status() const
+        {
+            return _info.si_status;
+        }
+
+        /**
+         * @brief faulting address, valid for SIGSEGV, SIGBUS, SIGILL and SIGFPE
+         */
+        void *address() const
+        {
+            return _info.si_addr;
+        }
+
+        /**
+         * @brief value passed to sigqueue
+         */
+        const union sigval &value() const
+        {
+            return _info.si_value;
+        }
+
+        /**
+         * @brief underlying siginfo_t
+         */
+        const siginfo_t &native() const
+        {
+            return _info;
+        }
+
+    private:
+        const siginfo_t &_info;
+    };
+
+#ifdef SIGFN_NO_HEAP
+    /**
+     * @brief signal handler function object type with delivery details
+     *
+     * @param info signal information for this delivery
+     */
+    typedef inplace_function<void(const signal_info &)> info_handler_function;
+#else
+    /**
+     * @brief signal handler function object type with delivery details
+     *
+     * @param info signal information for this delivery
+     */
+    typedef std::function<void(const signal_info &)> info_handler_function;
+#endif
+
+    /**
+     * @brief attach handler with delivery details to specific signal using copy semantics
+     *
+     * Installed with sigaction and SA_SIGINFO. The info is passed by
+     * reference from the kernel frame, without copies or allocations.
+     *
+     * @param signum signal to be handled
+     * @param info_handler_function function object associated with this signal
+     * @param flags bitwise OR of sigfn::flags, defaults to restart
+     */
+    DLL_EXPORT void handle_info(int signum, const info_handler_function &info_handler_function, int flags = restart);
+
+    /**
+     * @brief attach handler with delivery details to specific signal using move semantics
+     *
+     * @param signum signal to be handled
+     * @param info_handler_function function object associated with this signal
+     * @param flags bitwise OR of sigfn::flags, defaults to restart
+     */
+    DLL_EXPORT void handle_info(int signum, info_handler_function &&info_handler_function, int flags = restart);
+#endif
+
+    /**
+     * @brief attach handler to run on the sigfn dispatcher thread using copy semantics
+     *
+     * The signal handler only records the signal and wakes the dispatcher,
+     * so the handler may allocate, lock or log. Deliveries that arrive
+     * before the dispatcher runs are coalesced into a single call.
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     */
+    DLL_EXPORT void defer(int signum, const handler_function &handler_function);
+
+    /**
+     * @brief attach handler to run on the sigfn dispatcher thread using move semantics
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     */
+    DLL_EXPORT void defer(int signum, handler_function &&handler_function);
+
+    /**
+     * @brief removal token of an attached handler
+     */
+    typedef std::uint64_t handler_token;
+
+    /**
+     * @brief add handler to the chain of a specific signal using copy semantics
+     *
+     * Unlike handle, attaching never replaces another handler. Attached
+     * handlers run in the order they were attached, before the handler
+     * installed with handle or defer. Delivery walks the chain without a
+     * lock, and attaching or detaching publishes a new copy of it.
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @return token that detaches the handler
+     */
+    DLL_EXPORT handler_token attach(int signum, const handler_function &handler_function);
+
+    /**
+     * @brief add handler to the chain of a specific signal using move semantics
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @return token that detaches the handler
+     */
+    DLL_EXPORT handler_token attach(int signum, handler_function &&handler_function);
+
+    /**
+     * @brief add handler to the chain of a specific signal to run on the sigfn dispatcher thread using copy semantics
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @return token that detaches the handler
+     */
+    DLL_EXPORT handler_token attach_deferred(int signum, const handler_function &handler_function);
+
+    /**
+     * @brief add handler to the chain of a specific signal to run on the sigfn dispatcher thread using move semantics
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @return token that detaches the handler
+     */
+    DLL_EXPORT handler_token attach_deferred(int signum, handler_function &&handler_function);
+
+    /**
+     * @brief remove an attached handler
+     *
+     * The signal is reset to its default behavior when its last handler is
+     * removed. Calls to ignore or reset remove every attached handler.
+     *
+     * @param token token returned by attach or attach_deferred
+     * @return false if the handler was already removed
+     */
+    DLL_EXPORT bool detach(handler_token token);
+
+    namespace internal
+    {
+        class worker_pool;
+    }
+
+    /**
+     * @brief scheduling class of work run by a thread_pool
+     *
+     * Idle workers always take queued high priority work first, so a
+     * termination handler never waits behind queued bulk work.
+     */
+    enum class priority : int
+    {
+        high = 0,
+        normal = 1,
+        low = 2
+    };
+
+    /**
+     * @brief worker threads that run deferred handlers off the dispatcher thread
+     *
+     * Each worker owns one deque per priority, each behind its own mutex, and
+     * takes work from the other workers' deques when its own are empty.
+     * Handlers registered with a pool never run concurrently with
+     * themselves: a signal that arrives while its handler is running
+     * schedules exactly one more run afterwards.
+     */
+    class DLL_EXPORT thread_pool
+    {
+    public:
+        /**
+         * @brief start the worker threads
+         *
+         * @param workers number of worker threads, at least one
+         */
+        explicit thread_pool(std::size_t workers = std::max(1u, std::thread::hardware_concurrency()));
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /**
+         * @brief reset the signals still deferred to this pool, run the queued work and join the workers
+         *
+         * May run in a handler or in work of another pool: the memory of the
+         * pool is then freed once no delivery can still reach it. Must not
+         * run on one of the pool's own workers.
+         */
+        ~thread_pool();
+
+        /**
+         * @brief queue a task
+         *
+         * @param task function to run on a worker thread
+         * @param level scheduling class of the task
+         */
+        void post(std::function<void()> task, priority level = priority::normal);
+
+        /**
+         * @brief number of worker threads
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief queue a task with normal priority, so the pool can serve as a coroutine executor
+         */
+        void operator()(std::function<void()> task);
+
+    private:
+        friend DLL_EXPORT void defer(int, const handler_function &, thread_pool &, priority);
+        friend DLL_EXPORT void defer(int, handler_function &&, thread_pool &, priority);
+
+        std::unique_ptr<internal::worker_pool> _pool;
+    };
+
+    /**
+     * @brief attach handler to run on a thread pool using copy semantics
+     *
+     * The dispatcher thread only hands the signal to the pool, so a slow
+     * handler does not hold up handlers deferred to other workers.
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @param pool pool that runs the handler, must outlive the registration or be destroyed first
+     * @param level scheduling class of the handler
+     */
+    DLL_EXPORT void defer(int signum, const handler_function &handler_function, thread_pool &pool, priority level = priority::normal);
+
+    /**
+     * @brief attach handler to run on a thread pool using move semantics
+     *
+     * @param signum signal to be handled
+     * @param handler_function function object associated with this signal
+     * @param pool pool that runs the handler, must outlive the registration or be destroyed first
+     * @param level scheduling class of the handler
+     */
+    DLL_EXPORT void defer(int signum, handler_function &&handler_function, thread_pool &pool, priority level = priority::normal);
+
+#ifdef SIGFN_NO_HEAP
+    /**
+     * @brief batched signal handler function object type
+     *
+     * @param signum signal number
+     * @param count number of deliveries accumulated since the last batch
+     */
+    typedef inplace_function<void(int, std::uint64_t)> batch_function;
+#else
+    /**
+     * @brief batched signal handler function object type
+     *
+     * @param signum signal number
+     * @param count number of deliveries accumulated since the last batch
+     */
+    typedef std::function<void(int, std::uint64_t)> batch_function;
+#endif
+
+    /**
+     * @brief accumulate deliveries and run a batched handler on the dispatcher thread using copy semantics
+     *
+     * Each delivery only increments an atomic counter. The first delivery
+     * of a batch arms the window, and the handler runs once on the
+     * dispatcher thread when the window elapses or the threshold is
+     * reached, whichever comes first.
+     *
+     * @param signum signal to be handled
+     * @param batch_function function object associated with this signal
+     * @param window maximum time to hold a batch, zero flushes on the next dispatcher cycle
+     * @param threshold number of deliveries that flushes a batch early, zero disables it
+     */
+    DLL_EXPORT void coalesce(int signum, const batch_function &batch_function, const std::chrono::steady_clock::duration &window = std::chrono::steady_clock::duration::zero(), std::uint64_t threshold = 0);
+
+    /**
+     * @brief accumulate deliveries and run a batched handler on the dispatcher thread using move semantics
+     *
+     * @param signum signal to be handled
+     * @param batch_function function object associated with this signal
+     * @param window maximum time to hold a batch, zero flushes on the next dispatcher cycle
+     * @param threshold number of deliveries that flushes a batch early, zero disables it
+     */
+    DLL_EXPORT void coalesce(int signum, batch_function &&batch_function, const std::chrono::steady_clock::duration &window = std::chrono::steady_clock::duration::zero(), std::uint64_t threshold = 0);
+
+    /**
+     * @brief limit the deliveries of a signal with a token bucket
+     *
+     * Deliveries beyond the rate and burst are suppressed in the signal
+     * handler, before any registered handler runs, and counted in
+     * signal_stats::suppressed. Rate limits are kept per signal and
+     * survive later registrations.
+     *
+     * @param signum signal to be limited
+     * @param rate sustained deliveries per second, at most 1e9 and high
+     * enough that one interval fits in std::chrono::nanoseconds
+     * @param burst deliveries allowed back to back, at least 1
+     */
+    DLL_EXPORT void rate_limit(int signum, double rate, std::uint64_t burst = 1);
+
+    /**
+     * @brief pass the first delivery of a signal and suppress the rest for an interval
+     *
+     * @param signum signal to be limited
+     * @param interval time during which further deliveries are suppressed
+     */
+    DLL_EXPORT void throttle(int signum, const std::chrono::steady_clock::duration &interval);
+
+    /**
+     * @brief hold deliveries of a signal until it has been quiet for an interval
+     *
+     * A burst of deliveries produces a single trailing delivery. It runs
+     * once the signal has been quiet for the interval, on the dispatcher
+     * thread and without signal information.
+     *
+     * @param signum signal to be limited
+     * @param interval quiet time that ends a burst
+     */
+    DLL_EXPORT void debounce(int signum, const std::chrono::steady_clock::duration &interval);
+
+    /**
+     * @brief remove the rate limit, throttle or debounce of a signal
+     *
+     * @param signum signal to be unlimited
+     */
+    DLL_EXPORT void unlimit(int signum);
+
     /**
      * @brief ignore a specific signal
      *
@@ -85,9 +799,53 @@ namespace sigfn
      */
     DLL_EXPORT void reset(int signum);
 
+    /**
+     * @brief bit that represents a signal in the mask returned by poll
+     *
+     * @param signum signal number
+     * @return 1 << (signum - 1), 0 for an invalid signal number
+     */
+    constexpr std::uint64_t signal_bit(int signum)
+    {
+        return (signum > 0 && signum <= 64) ? (std::uint64_t(1) << (signum - 1)) : 0;
+    }
+
+    /**
+     * @brief record deliveries of a specific signal for polling
+     *
+     * Replaces the handler of the signal. A delivery only sets the bit of
+     * the signal in a process-wide atomic bitmap, which poll and pending
+     * read without a syscall. Handlers added with attach still run.
+     *
+     * @param signum signal to be watched
+     */
+    DLL_EXPORT void watch(int signum);
+
+    /**
+     * @brief fetch and clear the watched signals delivered since the last poll
+     *
+     * @return mask of signal_bit values
+     */
+    DLL_EXPORT std::uint64_t poll();
+
+    /**
+     * @brief check whether a watched signal was delivered since the last poll
+     *
+     * Costs a single relaxed load and does not clear the signal.
+     *
+     * @param signum signal number
+     * @return true if the signal is pending
+     */
+    DLL_EXPORT bool pending(int signum);
+
     /**
      * @brief wait for any signal in the list
      *
+     * The signals are blocked in the calling thread for the duration of the
+     * wait and consumed with sigwaitinfo, so registered handlers are left in
+     * place. Other threads should keep these signals blocked, otherwise the
+     * kernel may deliver them there instead.
+     *
      * @param signums list of signals to wait for
      * @return signal number
      */
@@ -110,6 +868,1187 @@ namespace sigfn
      * @return signal number if received before deadline
      */
     DLL_EXPORT std::optional<int> wait_until(std::initializer_list<int> signums, const std::chrono::system_clock::time_point &deadline);
+
+    class stop_token;
+
+    namespace internal
+    {
+        class stop_state;
+
+        /**
+         * @brief wait for any signal of an array until the token is stopped
+         *
+         * @return false if a stop was requested
+         */
+        DLL_EXPORT bool wait_stoppable(const int *signums, std::size_t count, int &signum, const stop_token &token);
+    }
+
+    /**
+     * @brief view of the stop state of a stop_source
+     *
+     * Tokens are cheap to copy and remain valid after their source is gone.
+     */
+    class DLL_EXPORT stop_token
+    {
+    public:
+        /**
+         * @brief construct a token that can never be stopped
+         */
+        stop_token() = default;
+
+        /**
+         * @brief check whether a stop was requested, a single atomic load
+         */
+        bool stop_requested() const noexcept
+        {
+            return _requested != nullptr && _requested->load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief check whether the token is associated with a stop_source
+         */
+        bool stop_possible() const noexcept
+        {
+            return _requested != nullptr;
+        }
+
+    private:
+        friend class stop_source;
+        friend class stop_callback;
+        friend DLL_EXPORT bool internal::wait_stoppable(const int *, std::size_t, int &, const stop_token &);
+
+        std::shared_ptr<internal::stop_state> _state;
+        const std::atomic<bool> *_requested = nullptr;
+    };
+
+    /**
+     * @brief stop request raised by any signal of a set
+     *
+     * The source attaches two handlers to each signal. The first one runs in
+     * signal context and only sets the stop flag, so it is
+     * async-signal-safe. The second one runs on the dispatcher thread. It
+     * invokes the registered stop_callback objects and wakes the threads
+     * blocked in a stoppable sigfn::wait. Other handlers of these signals
+     * are left in place.
+     */
+    class DLL_EXPORT stop_source
+    {
+    public:
+        /**
+         * @brief attach the stop handlers to the signals
+         *
+         * @param signums signals that request a stop, SIGINT and SIGTERM for example
+         */
+        explicit stop_source(std::initializer_list<int> signums);
+
+        /**
+         * @brief attach the stop handlers to the signals
+         *
+         * @param signums array of signal numbers
+         * @param count number of signals in the array
+         */
+        stop_source(const int *signums, std::size_t count);
+
+        stop_source(const stop_source &) = delete;
+        stop_source &operator=(const stop_source &) = delete;
+
+        /**
+         * @brief detach the stop handlers, outstanding tokens keep their state
+         */
+        ~stop_source();
+
+        /**
+         * @brief token that observes this source
+         */
+        stop_token get_token() const;
+
+        /**
+         * @brief check whether a stop was requested
+         */
+        bool stop_requested() const noexcept;
+
+        /**
+         * @brief request a stop without a signal, running the callbacks on the calling thread
+         *
+         * @return false if a stop was already requested
+         */
+        bool request_stop();
+
+    private:
+        std::shared_ptr<internal::stop_state> _state;
+        std::vector<handler_token> _tokens;
+    };
+
+    /**
+     * @brief callback invoked once when a stop is requested
+     *
+     * The callback runs on the thread that requested the stop, which is the
+     * dispatcher thread for a signal. It runs immediately if a stop was
+     * already requested. The destructor waits for a callback that is
+     * running on another thread. A typical callback notifies a condition
+     * variable that workers sleep on.
+     */
+    class DLL_EXPORT stop_callback
+    {
+    public:
+        /**
+         * @brief register the callback with the source of the token
+         *
+         * @param token token observing a stop_source
+         * @param callback function to invoke on stop
+         */
+        stop_callback(const stop_token &token, std::function<void()> callback);
+
+        stop_callback(const stop_callback &) = delete;
+        stop_callback &operator=(const stop_callback &) = delete;
+
+        /**
+         * @brief unregister the callback
+         */
+        ~stop_callback();
+
+    private:
+        friend class internal::stop_state;
+
+        std::shared_ptr<internal::stop_state> _state;
+        std::function<void()> _callback;
+    };
+
+    /**
+     * @brief wait for any signal in the list until a stop is requested
+     *
+     * Like wait, but a stop request wakes the waiting thread. A signal of the
+     * stop source that is consumed by the wait also requests the stop.
+     *
+     * @param signums list of signals to wait for
+     * @param token token observing a stop_source
+     * @return signal number, or no value if a stop was requested
+     */
+    DLL_EXPORT std::optional<int> wait(std::initializer_list<int> signums, const stop_token &token);
+
+    namespace internal
+    {
+        class shutdown_state;
+    }
+
+    /**
+     * @brief outcome of one component of a shutdown
+     */
+    enum class shutdown_status : int
+    {
+        /** the drain function returned */
+        completed = 0,
+        /** the drain function threw */
+        failed = 1,
+        /** the drain function was still running at its deadline */
+        timed_out = 2,
+        /** the stage never ran because the shutdown escalated */
+        skipped = 3
+    };
+
+    /**
+     * @brief timing of one component of a shutdown
+     */
+    struct shutdown_timing
+    {
+        /** name given to add */
+        std::string name;
+        /** stage given to add */
+        int stage;
+        /** outcome of the drain */
+        shutdown_status status;
+        /** time from the start of the stage until the drain returned or timed out */
+        std::chrono::nanoseconds elapsed;
+    };
+
+    /**
+     * @brief staged graceful shutdown driven by termination signals
+     *
+     * Components register a drain function with a stage and a timeout. The
+     * first termination signal releases wait, which drains the stages in
+     * ascending order. The components of a stage drain in parallel, each on
+     * its own thread. A second termination signal, or a component still
+     * running at its deadline, escalates: the escalation function runs, and
+     * the default one exits the process with _Exit(EXIT_FAILURE). The
+     * handlers are added with attach, so other handlers of the signals keep
+     * running.
+     */
+    class DLL_EXPORT shutdown_orchestrator
+    {
+    public:
+        /**
+         * @brief function invoked when a shutdown escalates
+         */
+        typedef std::function<void()> escalate_function;
+
+        /**
+         * @brief attach the termination handlers
+         *
+         * @param signums termination signals
+         * @param escalate function invoked on escalation, empty for _Exit(EXIT_FAILURE)
+         */
+        explicit shutdown_orchestrator(std::initializer_list<int> signums = {SIGINT, SIGTERM}, escalate_function escalate = escalate_function());
+
+        /**
+         * @brief attach the termination handlers
+         *
+         * @param signums array of signal numbers
+         * @param count number of signals in the array
+         * @param escalate function invoked on escalation, empty for _Exit(EXIT_FAILURE)
+         */
+        shutdown_orchestrator(const int *signums, std::size_t count, escalate_function escalate = escalate_function());
+
+        shutdown_orchestrator(const shutdown_orchestrator &) = delete;
+        shutdown_orchestrator &operator=(const shutdown_orchestrator &) = delete;
+
+        /**
+         * @brief detach the termination handlers
+         */
+        ~shutdown_orchestrator();
+
+        /**
+         * @brief register a component
+         *
+         * @param name name reported in the timings
+         * @param stage stages drain in ascending order
+         * @param timeout time the drain may take before the shutdown escalates
+         * @param drain function that tears the component down
+         */
+        void add(const std::string &name, int stage, const std::chrono::steady_clock::duration &timeout, std::function<void()> drain);
+
+        /**
+         * @brief check whether a termination signal was received
+         */
+        bool requested() const;
+
+        /**
+         * @brief block until the first termination signal, then drain every stage
+         *
+         * @return timing of every component, in stage order
+         */
+        std::vector<shutdown_timing> wait();
+
+        /**
+         * @brief drain every stage now, once
+         *
+         * @return timing of every component, in stage order
+         */
+        std::vector<shutdown_timing> run();
+
+    private:
+        std::shared_ptr<internal::shutdown_state> _state;
+        std::vector<handler_token> _tokens;
+    };
+
+    /**
+     * @brief pollable signal source for event loops
+     *
+     * Blocks a set of signals in the calling thread and exposes a file
+     * descriptor that becomes readable when any of them is pending. The
+     * descriptor can be registered with epoll, poll or select, and pending
+     * signals are drained in batches by dispatch(). Signals should be
+     * blocked in every thread for delivery to be reliable, so create the
+     * source before spawning threads. Requires signalfd (Linux).
+     */
+    class DLL_EXPORT event_source
+    {
+    public:
+        /**
+         * @brief block signals and open the source
+         *
+         * @param signums list of signals to consume
+         */
+        explicit event_source(std::initializer_list<int> signums);
+
+        /**
+         * @brief block signals and open the source
+         *
+         * @param signums array of signal numbers
+         * @param count number of signals in the array
+         */
+        event_source(const int *signums, std::size_t count);
+
+        event_source(const event_source &) = delete;
+        event_source &operator=(const event_source &) = delete;
+
+        /**
+         * @brief close the source and unblock its signals in the calling thread
+         *
+         * Only the signals the constructing thread had not already blocked
+         * are unblocked.
+         */
+        ~event_source();
+
+        /**
+         * @brief get the pollable file descriptor
+         *
+         * @return file descriptor that is readable while signals are pending
+         */
+        int fd() const;
+
+        /**
+         * @brief drain pending signals and invoke their registered handlers
+         *
+         * Handlers registered with handle() or defer() run in the calling
+         * thread, outside of signal context.
+         *
+         * @return number of signals drained
+         */
+        std::size_t dispatch();
+
+    private:
+        std::vector<int> _restore;
+        int _fd;
+    };
+
+#ifndef _WIN32
+    namespace internal
+    {
+        class realtime_ring;
+    }
+
+    /**
+     * @brief single realtime signal delivery captured by a realtime_queue
+     */
+    struct queued_signal
+    {
+        /// signal number
+        int signum;
+        /// signal code, SI_QUEUE for sigqueue
+        int code;
+        /// process id of the sender
+        pid_t pid;
+        /// real user id of the sender
+        uid_t uid;
+        /// value passed to sigqueue
+        union sigval value;
+    };
+
+    /**
+     * @brief lossless capture of realtime signals and their payloads
+     *
+     * Every delivery of the registered SIGRTMIN..SIGRTMAX signals is pushed
+     * from the signal handler into a preallocated lock-free ring, so queued
+     * signals and their sigqueue values are never coalesced. Deliveries that
+     * find the ring full are counted instead of silently dropped.
+     */
+    class DLL_EXPORT realtime_queue
+    {
+    public:
+        /**
+         * @brief register the signals and preallocate the ring
+         *
+         * @param signums list of realtime signals to capture
+         * @param capacity minimum number of buffered deliveries, rounded up to a power of two
+         */
+        realtime_queue(std::initializer_list<int> signums, std::size_t capacity);
+
+        /**
+         * @brief register the signals and preallocate the ring
+         *
+         * @param signums array of realtime signal numbers
+         * @param count number of signals in the array
+         * @param capacity minimum number of buffered deliveries, rounded up to a power of two
+         */
+        realtime_queue(const int *signums, std::size_t count, std::size_t capacity);
+
+        realtime_queue(const realtime_queue &) = delete;
+        realtime_queue &operator=(const realtime_queue &) = delete;
+
+        /**
+         * @brief give the captured signals back to their previous handlers
+         *
+         * A signal that was at its default action keeps an empty sigfn
+         * handler, so a delivery still queued for it is dropped instead of
+         * terminating the process.
+         */
+        ~realtime_queue();
+
+        /**
+         * @brief move buffered deliveries out of the ring in arrival order
+         *
+         * @param signals destination array
+         * @param max capacity of the destination array
+         * @return number of deliveries written to signals
+         */
+        std::size_t drain(queued_signal *signals, std::size_t max);
+
+        /**
+         * @brief number of deliveries lost because the ring was full
+         *
+         * @return overflow count since the queue was created
+         */
+        std::uint64_t overflows() const;
+
+    private:
+        std::vector<handler_token> _tokens;
+        std::shared_ptr<internal::realtime_ring> _ring;
+    };
+
+    namespace internal
+    {
+        class child_registry;
+    }
+
+    /**
+     * @brief exit of a child process reaped by a child_watcher
+     */
+    struct child_exit
+    {
+        /// process id of the child
+        pid_t pid;
+        /// CLD_EXITED, CLD_KILLED or CLD_DUMPED
+        int code;
+        /// exit status for CLD_EXITED, otherwise the terminating signal
+        int status;
+        /// resources used by the child
+        struct rusage usage;
+    };
+
+    /**
+     * @brief SIGCHLD reaper with per-child exit callbacks
+     *
+     * Watchers are kept in a hash indexed by pid and reaped in batches on
+     * the dispatcher thread, so the cost of a SIGCHLD depends on the
+     * children that exited rather than on the children being watched.
+     * Where the kernel supports pidfds (Linux 5.4), every watched child is
+     * registered with an epoll set and only watched children are reaped.
+     * Elsewhere every child of the process is reaped with wait4, including
+     * children started by system(), popen() or other code that waits for
+     * them itself, which then loses their exit status. The exits of children
+     * that are not watched yet are kept until watch() claims them, up to the
+     * 1024 most recent. Only one watcher should exist per process. The
+     * handler is added with attach_deferred, so other handlers of SIGCHLD
+     * keep running.
+     */
+    class DLL_EXPORT child_watcher
+    {
+    public:
+        /**
+         * @brief function invoked when a watched child exits
+         */
+        typedef std::function<void(const child_exit &)> exit_function;
+
+        /**
+         * @brief attach the SIGCHLD handler
+         */
+        child_watcher();
+
+        child_watcher(const child_watcher &) = delete;
+        child_watcher &operator=(const child_watcher &) = delete;
+
+        /**
+         * @brief detach the SIGCHLD handler
+         */
+        ~child_watcher();
+
+        /**
+         * @brief invoke a callback when a child exits
+         *
+         * A child that already exited is reaped at once and its callback
+         * runs in the calling thread; otherwise the callback runs on the
+         * dispatcher thread.
+         *
+         * @param pid process id of a child of this process
+         * @param callback function invoked with the exit of the child
+         */
+        void watch(pid_t pid, exit_function callback);
+
+        /**
+         * @brief stop watching a child without reaping it
+         *
+         * @param pid process id of the child
+         * @return true if the child was watched
+         */
+        bool unwatch(pid_t pid);
+
+        /**
+         * @brief reap exited children and invoke their callbacks now
+         *
+         * @return number of callbacks invoked
+         */
+        std::size_t reap();
+
+        /**
+         * @brief number of children being watched
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief check whether children are tracked with pidfds
+         */
+        bool uses_pidfd() const;
+
+    private:
+        std::shared_ptr<internal::child_registry> _registry;
+        handler_token _token;
+    };
+
+    namespace internal
+    {
+        class timer_engine;
+    }
+
+    /**
+     * @brief identifier of a timer scheduled on a timer_wheel
+     */
+    typedef std::uint64_t timer_id;
+
+    /**
+     * @brief many logical timers multiplexed onto one POSIX timer
+     *
+     * Timers live on a hierarchical wheel of four levels of 64 slots, driven
+     * by a single periodic kernel timer that delivers a realtime signal
+     * through the sigfn dispatch path. The kernel timer only runs while
+     * timers are scheduled. Expirations, overruns included, are counted in
+     * signal context and the wheel is advanced on the dispatcher thread,
+     * where the callbacks run. A periodic timer that missed expirations
+     * fires once and reports the number it missed. The signal is reserved
+     * for the wheel while it exists.
+     */
+    class DLL_EXPORT timer_wheel
+    {
+    public:
+        /**
+         * @brief function invoked when a timer fires
+         *
+         * @param id timer that fired
+         * @param overruns number of periods missed since the previous call
+         */
+        typedef std::function<void(timer_id id, std::uint64_t overruns)> timer_function;
+
+        /**
+         * @brief create the kernel timer and install the handler of its signal
+         *
+         * @param signum realtime signal delivered by the kernel timer
+         * @param tick resolution of the wheel
+         */
+        explicit timer_wheel(int signum, const std::chrono::steady_clock::duration &tick = std::chrono::milliseconds(1));
+
+        timer_wheel(const timer_wheel &) = delete;
+        timer_wheel &operator=(const timer_wheel &) = delete;
+
+        /**
+         * @brief delete the kernel timer and give its signal back to the previous handler
+         *
+         * A signal that was at its default action keeps an empty sigfn
+         * handler, so an expiry still queued for it is dropped instead of
+         * terminating the process.
+         */
+        ~timer_wheel();
+
+        /**
+         * @brief schedule a timer
+         *
+         * Durations are rounded up to whole ticks.
+         *
+         * @param after time until the first expiration
+         * @param callback function invoked on the dispatcher thread
+         * @param period time between expirations, zero for a one-shot timer
+         * @return identifier for cancel
+         */
+        timer_id schedule(const std::chrono::steady_clock::duration &after, timer_function callback, const std::chrono::steady_clock::duration &period = std::chrono::steady_clock::duration::zero());
+
+        /**
+         * @brief cancel a timer
+         *
+         * A callback that is already running, or already due in the
+         * current batch, may still complete once.
+         *
+         * @param id identifier returned by schedule
+         * @return false if the timer already fired or was cancelled
+         */
+        bool cancel(timer_id id);
+
+        /**
+         * @brief number of scheduled timers
+         */
+        std::size_t size() const;
+
+    private:
+        std::shared_ptr<internal::timer_engine> _engine;
+        handler_token _claim;
+        handler_token _token;
+    };
+
+    namespace internal
+    {
+        class interrupt_registry;
+        struct interrupt_slot;
+    }
+
+    /**
+     * @brief identifier of a thread registered with a thread_interrupter
+     */
+    typedef std::uint64_t thread_token;
+
+    /**
+     * @brief interrupts specific threads out of blocking system calls
+     *
+     * Owns a reserved realtime signal, installed without SA_RESTART, and
+     * sends it to one registered thread with pthread_kill. A read, accept or
+     * similar call blocked in that thread fails with EINTR, and the
+     * thread's interrupt flag tells it why. Threads register with an
+     * interrupt_scope.
+     */
+    class DLL_EXPORT thread_interrupter
+    {
+    public:
+        /**
+         * @brief install the handler of the reserved signal
+         *
+         * @param signum realtime signal reserved for interruptions
+         */
+        explicit thread_interrupter(int signum);
+
+        thread_interrupter(const thread_interrupter &) = delete;
+        thread_interrupter &operator=(const thread_interrupter &) = delete;
+
+        /**
+         * @brief give the reserved signal back to its previous handler
+         *
+         * A signal that was at its default action keeps an empty sigfn
+         * handler, so an interruption still queued for it is dropped instead
+         * of terminating the process.
+         */
+        ~thread_interrupter();
+
+        /**
+         * @brief set the interrupt flag of a thread and signal it
+         *
+         * @param token token of an interrupt_scope
+         * @return false if the thread is no longer registered
+         */
+        bool interrupt(thread_token token);
+
+        /**
+         * @brief number of registered threads
+         */
+        std::size_t size() const;
+
+    private:
+        friend class interrupt_scope;
+        std::shared_ptr<internal::interrupt_registry> _registry;
+        handler_token _token;
+    };
+
+    /**
+     * @brief registration of the calling thread with a thread_interrupter
+     *
+     * Must be destroyed on the thread that created it, and a thread can
+     * only hold one scope per interrupter at a time.
+     */
+    class DLL_EXPORT interrupt_scope
+    {
+    public:
+        /**
+         * @brief register the calling thread
+         *
+         * @param interrupter interrupter that may signal this thread
+         * @param callback optional function run in this thread, in signal context, on each interruption
+         */
+        explicit interrupt_scope(thread_interrupter &interrupter, handler_function callback = handler_function());
+
+        interrupt_scope(const interrupt_scope &) = delete;
+        interrupt_scope &operator=(const interrupt_scope &) = delete;
+
+        /**
+         * @brief unregister the calling thread
+         */
+        ~interrupt_scope();
+
+        /**
+         * @brief get the token other threads pass to interrupt
+         */
+        thread_token token() const;
+
+        /**
+         * @brief check whether this thread was interrupted
+         *
+         * A single acquire load, cheap enough for the retry loop around a
+         * blocking call.
+         */
+        bool interrupted() const
+        {
+            return _flag->load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief clear the interrupt flag
+         *
+         * @return true if the flag was set
+         */
+        bool reset();
+
+    private:
+        std::shared_ptr<internal::interrupt_registry> _registry;
+        std::shared_ptr<internal::interrupt_slot> _slot;
+        const std::atomic<bool> *_flag;
+        thread_token _token;
+    };
+#endif
+
+    /**
+     * @brief number of log2 buckets in the handler time histogram
+     */
+    constexpr std::size_t histogram_buckets = 32;
+
+    /**
+     * @brief snapshot of the delivery counters kept for one signal
+     */
+    struct signal_stats
+    {
+        /** signal number */
+        int signum;
+        /** deliveries received by the sigfn signal handler */
+        std::uint64_t deliveries;
+        /** immediate, deferred and batched handler invocations */
+        std::uint64_t invocations;
+        /** total time spent in handlers */
+        std::chrono::nanoseconds handler_time;
+        /** longest single handler invocation */
+        std::chrono::nanoseconds max_handler_time;
+        /** deliveries folded into an already pending deferred run or batch */
+        std::uint64_t coalesced;
+        /** deliveries lost because no handler was installed or a realtime queue was full */
+        std::uint64_t dropped;
+        /** deliveries rejected or folded by a rate limit, throttle or debounce */
+        std::uint64_t suppressed;
+        /** handler times, bucket i counts invocations taking [2^i, 2^(i+1)) ns, except that bucket 0 also counts 0 ns and the last bucket has no upper bound */
+        std::array<std::uint64_t, histogram_buckets> histogram;
+    };
+
+    /**
+     * @brief read the delivery counters of a signal without blocking delivery
+     *
+     * Counters are read one at a time, so a snapshot taken while the signal
+     * is firing may be off by the deliveries that raced with it. Handlers
+     * registered with handle<Signum> bypass the counters.
+     *
+     * @param signum signal number
+     * @return counter snapshot
+     */
+    DLL_EXPORT signal_stats stats(int signum);
+
+    /**
+     * @brief read the delivery counters of every signal that has fired
+     *
+     * @return snapshots of signals with at least one delivery or invocation
+     */
+    DLL_EXPORT std::vector<signal_stats> stats();
+
+    /**
+     * @brief zero the delivery counters of every signal
+     */
+    DLL_EXPORT void reset_stats();
+
+#ifndef _WIN32
+    /**
+     * @brief trace dump formats, see sigfn_trace_header and sigfn_trace_event
+     */
+    enum class trace_format : int
+    {
+        binary = 0,
+        chrome = 1
+    };
+
+    /**
+     * @brief start recording deliveries and handler runs into per-thread rings
+     *
+     * The rings are allocated by the first call and reused afterwards, so
+     * later calls only resume recording. Recording is wait-free and each
+     * ring keeps the most recent events.
+     *
+     * @param threads number of threads that can record events
+     * @param capacity events kept per thread, rounded up to a power of two
+     */
+    DLL_EXPORT void trace_start(std::size_t threads = 64, std::size_t capacity = 4096);
+
+    /**
+     * @brief stop recording, recorded events are kept
+     */
+    DLL_EXPORT void trace_stop();
+
+    /**
+     * @brief write the recorded events to a file descriptor
+     *
+     * Only async-signal-safe calls are made, so this can run in a handler.
+     *
+     * @param fd destination file descriptor
+     * @param format output format
+     */
+    DLL_EXPORT void trace_dump(int fd, trace_format format = trace_format::chrome);
+
+    /**
+     * @brief dump the recorded events whenever a signal is received
+     *
+     * The dump is added with attach, so other handlers of the signal keep
+     * running.
+     *
+     * @param signum signal that triggers the dump, typically SIGUSR2
+     * @param fd destination file descriptor
+     * @param format output format
+     * @return token for detach
+     */
+    DLL_EXPORT handler_token trace_dump_on(int signum, int fd, trace_format format = trace_format::binary);
+
+    /**
+     * @brief report fatal signals to a file descriptor
+     *
+     * The handlers are installed with sigaction, SA_SIGINFO and SA_ONSTACK,
+     * outside of the sigfn handler table. On a fatal signal the signal,
+     * fault address, registers and a backtrace of at most 64 frames are
+     * written to the descriptor with async-signal-safe calls only. Then the
+     * previous handler is reinstalled and gets the signal, by the faulting
+     * instruction trapping again or by raising it, so a handler that
+     * recovers keeps the process alive; the reporter stays uninstalled for
+     * that signal. Without a previous handler the signal is raised again
+     * with SIG_DFL. The descriptor should be a file, or a pipe that is drained, so the
+     * report cannot block. Installing also gives the calling thread an
+     * alternate signal stack.
+     *
+     * @param fd pre-opened destination file descriptor
+     * @param signums signals to report
+     */
+    DLL_EXPORT void crash_install(int fd, std::initializer_list<int> signums = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT});
+
+    /**
+     * @brief report fatal signals to a file descriptor
+     *
+     * @param fd pre-opened destination file descriptor
+     * @param signums array of signals to report
+     * @param count number of signals in the array
+     */
+    DLL_EXPORT void crash_install(int fd, const int *signums, std::size_t count);
+
+    /**
+     * @brief give the calling thread an alternate signal stack
+     *
+     * Without one, a stack overflow cannot be reported. Threads that
+     * already have an alternate stack keep it.
+     */
+    DLL_EXPORT void crash_thread_init();
+
+    /**
+     * @brief restore the dispositions replaced by crash_install
+     */
+    DLL_EXPORT void crash_uninstall();
+
+    namespace internal
+    {
+        class sample_profiler;
+    }
+
+    /**
+     * @brief sampling CPU profiler driven by SIGPROF
+     *
+     * While running, setitimer(ITIMER_PROF) delivers SIGPROF at the
+     * configured frequency of consumed CPU time. A handler that takes over
+     * SIGPROF while sampling records the stack of the interrupted thread
+     * into that thread's ring, without locks or allocations. The rings are drained and aggregated by
+     * a deferred handler on the dispatcher thread, and dump writes the
+     * aggregated stacks in the folded format read by flamegraph.pl. Only
+     * one profiler can run at a time, since the interval timer is shared
+     * by the process.
+     */
+    class DLL_EXPORT profiler
+    {
+    public:
+        /**
+         * @brief allocate the rings
+         *
+         * @param frequency samples per second of CPU time
+         * @param threads number of threads that can record samples
+         * @param capacity samples buffered per thread, rounded up to a power of two
+         */
+        explicit profiler(unsigned int frequency = 100, std::size_t threads = 64, std::size_t capacity = 128);
+
+        profiler(const profiler &) = delete;
+        profiler &operator=(const profiler &) = delete;
+
+        /**
+         * @brief stop sampling
+         */
+        ~profiler();
+
+        /**
+         * @brief take over SIGPROF and arm the interval timer
+         */
+        void start();
+
+        /**
+         * @brief disarm the interval timer, aggregated samples are kept
+         *
+         * SIGPROF goes back to its previous handler. If it was at its
+         * default action, an empty sigfn handler stays, so a sample still
+         * pending is dropped instead of terminating the process.
+         */
+        void stop();
+
+        /**
+         * @brief check whether this profiler is sampling
+         */
+        bool running() const;
+
+        /**
+         * @brief number of samples recorded
+         */
+        std::uint64_t samples() const;
+
+        /**
+         * @brief number of samples lost because a ring was full or no ring was free
+         */
+        std::uint64_t dropped() const;
+
+        /**
+         * @brief write the aggregated stacks as folded lines to a file descriptor
+         *
+         * Each line lists the frames from the outermost to the sampled one,
+         * separated by semicolons, followed by a space and the sample count.
+         * Symbols are resolved with dladdr, so executables should be linked
+         * with -rdynamic for their own functions to be named.
+         *
+         * @param fd destination file descriptor
+         */
+        void dump(int fd);
+
+        /**
+         * @brief discard the aggregated stacks and counters
+         */
+        void clear();
+
+    private:
+        std::shared_ptr<internal::sample_profiler> _profiler;
+        handler_token _claim;
+        handler_token _token;
+    };
+
+    /**
+     * @brief keeps SIGPIPE from terminating the process during a scope
+     *
+     * Blocks SIGPIPE on the calling thread, so a write to a closed pipe or
+     * socket only fails with EPIPE, without changing the process-wide
+     * disposition other libraries may rely on. On destruction a SIGPIPE
+     * raised in the scope is consumed with a zero timeout wait, and only
+     * when sigpending reports one, then the mask is restored. A SIGPIPE
+     * that was already pending is left pending. Nested guards on the same
+     * thread make no system calls. Handlers of SIGPIPE do not run for
+     * signals consumed by the guard.
+     */
+    class DLL_EXPORT suppress_sigpipe
+    {
+    public:
+        /**
+         * @brief block SIGPIPE on the calling thread
+         */
+        suppress_sigpipe();
+
+        suppress_sigpipe(const suppress_sigpipe &) = delete;
+        suppress_sigpipe &operator=(const suppress_sigpipe &) = delete;
+
+        /**
+         * @brief consume a SIGPIPE raised in the scope and restore the mask
+         */
+        ~suppress_sigpipe();
+
+    private:
+        bool _nested;
+        bool _restore;
+        bool _pending;
+    };
+#endif
+
+    namespace internal
+    {
+        // completion target of a waiter registered with subscribe
+        class async_waiter
+        {
+        public:
+            // Called once on a sigfn-owned thread, with 0 on timeout. Returns
+            // the task that resumes the waiter; unsubscribe waits for complete
+            // to return, so only the task may outlive the waiter.
+            virtual std::function<void()> complete(int signum) noexcept = 0;
+
+        protected:
+            ~async_waiter() = default;
+        };
+
+        // registers the waiter with the shared signal source
+        DLL_EXPORT void subscribe(async_waiter *waiter, const int *signums, std::size_t count, const std::optional<std::chrono::steady_clock::time_point> &deadline);
+
+        // removes the waiter if it has not completed yet
+        DLL_EXPORT void unsubscribe(async_waiter *waiter);
+    }
+
+#if defined(SIGFN_COROUTINES) && defined(__cpp_impl_coroutine)
+    /**
+     * @brief executor that resumes the coroutine on the sigfn thread that completed the wait
+     */
+    struct inline_executor
+    {
+        template <class F>
+        void operator()(F &&task) const
+        {
+            task();
+        }
+    };
+
+    /**
+     * @brief awaitable returned by async_wait
+     *
+     * Suspends the awaiting coroutine until one of the signals arrives, then
+     * hands its resumption to the executor. Waiters do not own threads: every
+     * waiter on a signal shares one deferred handler, and timeouts share one
+     * timer thread. The handler is attached while a coroutine waits on the
+     * signal and detached when the last waiter leaves, so other handlers of
+     * the signal keep running and a signal that arrives while no coroutine is
+     * waiting is not seen by a later async_wait.
+     *
+     * @tparam Executor callable that schedules a nullary task
+     */
+    template <class Executor>
+    class signal_awaitable : private internal::async_waiter
+    {
+    public:
+        signal_awaitable(std::vector<int> signums, const std::optional<std::chrono::steady_clock::time_point> &deadline, Executor executor)
+            : _signums(std::move(signums)), _deadline(deadline), _executor(std::move(executor)), _signum(0)
+        {
+        }
+
+        signal_awaitable(const signal_awaitable &) = delete;
+        signal_awaitable &operator=(const signal_awaitable &) = delete;
+
+        ~signal_awaitable()
+        {
+            internal::unsubscribe(this);
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            _handle = handle;
+            // the coroutine may be resumed on another thread as soon as the
+            // waiter is registered, so nothing is touched afterwards
+            internal::subscribe(this, _signums.data(), _signums.size(), _deadline);
+        }
+
+        /**
+         * @brief signal that completed the wait
+         */
+        int await_resume() const noexcept
+        {
+            return _signum;
+        }
+
+    private:
+        std::function<void()> complete(int signum) noexcept override
+        {
+            _signum = signum;
+            return [executor = _executor, handle = _handle]() mutable
+            {
+                executor(
+                    [handle]()
+                    {
+                        handle.resume();
+                    });
+            };
+        }
+
+        std::vector<int> _signums;
+        std::optional<std::chrono::steady_clock::time_point> _deadline;
+        Executor _executor;
+        std::coroutine_handle<> _handle;
+        int _signum;
+    };
+
+    /**
+     * @brief awaitable returned by async_wait_for
+     */
+    template <class Executor>
+    class timed_signal_awaitable : public signal_awaitable<Executor>
+    {
+    public:
+        using signal_awaitable<Executor>::signal_awaitable;
+
+        /**
+         * @brief signal that completed the wait, empty on timeout
+         */
+        std::optional<int> await_resume() const noexcept
+        {
+            const int signum = signal_awaitable<Executor>::await_resume();
+            return (signum != 0) ? std::optional<int>(signum) : std::nullopt;
+        }
+    };
+
+    /**
+     * @brief suspend the calling coroutine until a signal is received
+     *
+     * @param signums list of signals to wait for
+     * @param executor schedules the resumption, by default it runs on the sigfn thread
+     * @return awaitable producing the received signal number
+     */
+    template <class Executor = inline_executor>
+    signal_awaitable<Executor> async_wait(std::initializer_list<int> signums, Executor executor = Executor())
+    {
+        return signal_awaitable<Executor>(std::vector<int>(signums), std::nullopt, std::move(executor));
+    }
+
+    /**
+     * @brief suspend the calling coroutine until a signal is received
+     *
+     * Older GCC releases reject braced lists inside co_await expressions,
+     * this overload works with a named array instead.
+     *
+     * @param signums array of signal numbers
+     * @param count number of signals in the array
+     * @param executor schedules the resumption, by default it runs on the sigfn thread
+     * @return awaitable producing the received signal number
+     */
+    template <class Executor = inline_executor>
+    signal_awaitable<Executor> async_wait(const int *signums, std::size_t count, Executor executor = Executor())
+    {
+        return signal_awaitable<Executor>(std::vector<int>(signums, signums + count), std::nullopt, std::move(executor));
+    }
+
+    /**
+     * @brief suspend the calling coroutine until a signal is received or the timeout expires
+     *
+     * @param signums list of signals to wait for
+     * @param timeout maximum time to wait
+     * @param executor schedules the resumption, by default it runs on the sigfn thread
+     * @return awaitable producing the received signal number, empty on timeout
+     */
+    template <class Rep, class Period, class Executor = inline_executor>
+    timed_signal_awaitable<Executor> async_wait_for(std::initializer_list<int> signums, const std::chrono::duration<Rep, Period> &timeout, Executor executor = Executor())
+    {
+        return timed_signal_awaitable<Executor>(
+            std::vector<int>(signums),
+            std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout),
+            std::move(executor));
+    }
+
+    /**
+     * @brief suspend the calling coroutine until a signal is received or the timeout expires
+     *
+     * @param signums array of signal numbers
+     * @param count number of signals in the array
+     * @param timeout maximum time to wait
+     * @param executor schedules the resumption, by default it runs on the sigfn thread
+     * @return awaitable producing the received signal number, empty on timeout
+     */
+    template <class Rep, class Period, class Executor = inline_executor>
+    timed_signal_awaitable<Executor> async_wait_for(const int *signums, std::size_t count, const std::chrono::duration<Rep, Period> &timeout, Executor executor = Executor())
+    {
+        return timed_signal_awaitable<Executor>(
+            std::vector<int>(signums, signums + count),
+            std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout),
+            std::move(executor));
+    }
+#endif
 }
 
-#endif
\ No newline at end of file
+#endif
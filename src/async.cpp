@@ -0,0 +1,241 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+sigfn::internal::async_registry::~async_registry()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stopping = true;
+    _changed.notify_all();
+    lock.unlock();
+    if (_timer.joinable())
+    {
+        _timer.join();
+    }
+}
+
+void sigfn::internal::async_registry::subscribe(async_waiter *waiter, const int *signums, std::size_t count, const std::optional<std::chrono::steady_clock::time_point> &deadline)
+{
+    if (signums == nullptr || count == 0)
+    {
+        throw error(empty_sigset);
+    }
+    for (std::size_t index = 0; index < count; index++)
+    {
+        if (signums[index] <= 0 || signums[index] >= signal_count)
+        {
+            throw error(invalid_signum);
+        }
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<int> attached;
+    for (std::size_t index = 0; index < count; index++)
+    {
+        // attached while the signal has waiters, so other handlers of it keep running
+        if (_tokens[signums[index]] == 0)
+        {
+            try
+            {
+                _tokens[signums[index]] = sigfn::attach_deferred(
+                    signums[index],
+                    [](int signum)
+                    {
+                        state::async_waiters.fire(signum);
+                    });
+            }
+            catch (...)
+            {
+                for (int value : attached)
+                {
+                    release(value);
+                }
+                throw;
+            }
+            attached.push_back(signums[index]);
+        }
+    }
+    subscription entry;
+    entry.signums.assign(signums, signums + count);
+    if (deadline.has_value())
+    {
+        if (!_timer.joinable())
+        {
+#ifdef _WIN32
+            _timer = std::thread(&async_registry::run, this);
+#else
+            // like the dispatcher, the timer never steals signals from waiting threads
+            sigset_t blocked;
+            sigset_t previous;
+            sigfillset(&blocked);
+            pthread_sigmask(SIG_SETMASK, &blocked, &previous);
+            try
+            {
+                _timer = std::thread(&async_registry::run, this);
+            }
+            catch (...)
+            {
+                pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+                throw;
+            }
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+#endif
+        }
+        entry.deadline = _deadlines.emplace(deadline.value(), waiter);
+        _changed.notify_all();
+    }
+    for (int value : entry.signums)
+    {
+        _waiting[value].insert(waiter);
+    }
+    _subscriptions.emplace(waiter, std::move(entry));
+}
+
+void sigfn::internal::async_registry::unsubscribe(async_waiter *waiter)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    remove(waiter);
+    // a waiter being completed is still read by complete, so it must outlive the call
+    _completed.wait(
+        lock,
+        [this, waiter]()
+        {
+            return _completing.count(waiter) == 0;
+        });
+}
+
+void sigfn::internal::async_registry::fire(int signum)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const std::vector<async_waiter *> ready(_waiting[signum].begin(), _waiting[signum].end());
+    for (async_waiter *waiter : ready)
+    {
+        remove(waiter);
+    }
+    finish(ready, signum, lock);
+}
+
+void sigfn::internal::async_registry::finish(const std::vector<async_waiter *> &ready, int signum, std::unique_lock<std::mutex> &lock)
+{
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(ready.size());
+    _completing.insert(ready.begin(), ready.end());
+    lock.unlock();
+    for (async_waiter *waiter : ready)
+    {
+        tasks.push_back(waiter->complete(signum));
+    }
+    lock.lock();
+    for (async_waiter *waiter : ready)
+    {
+        _completing.erase(waiter);
+    }
+    _completed.notify_all();
+    // resumed outside the lock, so a resumed coroutine can wait again
+    lock.unlock();
+    for (std::function<void()> &task : tasks)
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            // an executor that throws must not strand the other waiters
+        }
+    }
+    lock.lock();
+}
+
+void sigfn::internal::async_registry::remove(async_waiter *waiter)
+{
+    const std::unordered_map<async_waiter *, subscription>::iterator found = _subscriptions.find(waiter);
+    if (found != _subscriptions.end())
+    {
+        for (int signum : found->second.signums)
+        {
+            _waiting[signum].erase(waiter);
+            release(signum);
+        }
+        if (found->second.deadline.has_value())
+        {
+            _deadlines.erase(found->second.deadline.value());
+        }
+        _subscriptions.erase(found);
+    }
+}
+
+void sigfn::internal::async_registry::release(int signum)
+{
+    if (_waiting[signum].empty() && _tokens[signum] != 0)
+    {
+        try
+        {
+            // false if a reset already dropped the handler
+            sigfn::detach(_tokens[signum]);
+        }
+        catch (...)
+        {
+            // the handler stays attached and fires into an empty wait set
+            return;
+        }
+        _tokens[signum] = 0;
+    }
+}
+
+void sigfn::internal::async_registry::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stopping)
+    {
+        if (_deadlines.empty())
+        {
+            _changed.wait(lock);
+        }
+        else if (_deadlines.begin()->first <= std::chrono::steady_clock::now())
+        {
+            const std::vector<async_waiter *> ready(1, _deadlines.begin()->second);
+            remove(ready.front());
+            finish(ready, 0, lock);
+        }
+        else
+        {
+            // copied, the node may be erased while the lock is released
+            const std::chrono::steady_clock::time_point deadline = _deadlines.begin()->first;
+            _changed.wait_until(lock, deadline);
+        }
+    }
+}
+
+void sigfn::internal::subscribe(async_waiter *waiter, const int *signums, std::size_t count, const std::optional<std::chrono::steady_clock::time_point> &deadline)
+{
+#ifdef _WIN32
+    throw error(unsupported);
+#else
+    state::async_waiters.subscribe(waiter, signums, count, deadline);
+#endif
+}
+
+void sigfn::internal::unsubscribe(async_waiter *waiter)
+{
+    state::async_waiters.unsubscribe(waiter);
+}
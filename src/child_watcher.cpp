@@ -0,0 +1,379 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_pidfd_open) && defined(SYS_waitid)
+#define SIGFN_PIDFD
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+#endif
+
+namespace
+{
+    // exits reported per epoll_wait call while reaping
+    constexpr int reap_batch = 64;
+
+    // exits of unwatched children kept for a later watch() without pidfds;
+    // the oldest is dropped beyond this, so unrelated children cannot grow it forever
+    constexpr std::size_t unclaimed_capacity = 1024;
+
+    sigfn::child_exit make_exit(pid_t pid, int status, const struct rusage &usage)
+    {
+        sigfn::child_exit exit = {};
+        exit.pid = pid;
+        if (WIFEXITED(status))
+        {
+            exit.code = CLD_EXITED;
+            exit.status = WEXITSTATUS(status);
+        }
+        else
+        {
+#ifdef WCOREDUMP
+            exit.code = WCOREDUMP(status) ? CLD_DUMPED : CLD_KILLED;
+#else
+            exit.code = CLD_KILLED;
+#endif
+            exit.status = WTERMSIG(status);
+        }
+        exit.usage = usage;
+        return exit;
+    }
+
+#ifdef SIGFN_PIDFD
+    int pidfd_open(pid_t pid)
+    {
+        return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    }
+
+    // the waitid wrapper in libc has no rusage argument, the system call does
+    int pidfd_wait(int fd, siginfo_t &info, struct rusage &usage)
+    {
+        info = {};
+        usage = {};
+        return static_cast<int>(syscall(SYS_waitid, P_PIDFD, fd, &info, WEXITED | WNOHANG, &usage));
+    }
+#endif
+}
+
+sigfn::internal::child_registry::child_registry() : _epoll(-1)
+{
+#ifdef SIGFN_PIDFD
+    // waitid(P_PIDFD) arrived one release after pidfd_open, so probe both;
+    // the process is not its own child, which the newer kernels report
+    // as ECHILD and the older ones as EINVAL
+    const int self = pidfd_open(getpid());
+    if (self >= 0)
+    {
+        siginfo_t info;
+        struct rusage usage;
+        if (pidfd_wait(self, info, usage) == -1 && errno == ECHILD)
+        {
+            _epoll = epoll_create1(EPOLL_CLOEXEC);
+        }
+        close(self);
+    }
+#endif
+}
+
+sigfn::internal::child_registry::~child_registry()
+{
+    for (const std::pair<const pid_t, watcher> &watched : _watchers)
+    {
+        if (watched.second.fd >= 0)
+        {
+            close(watched.second.fd);
+        }
+    }
+    if (_epoll >= 0)
+    {
+        close(_epoll);
+    }
+}
+
+void sigfn::internal::child_registry::watch(pid_t pid, sigfn::child_watcher::exit_function callback)
+{
+    if (pid <= 0)
+    {
+        throw error(invalid_child);
+    }
+    if (!callback)
+    {
+        throw error(invalid_handler);
+    }
+    completions done;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (_watchers.count(pid) != 0)
+        {
+            throw error(invalid_child);
+        }
+        if (_epoll >= 0)
+        {
+#ifdef SIGFN_PIDFD
+            const int fd = pidfd_open(pid);
+            if (fd < 0)
+            {
+                throw error(invalid_child);
+            }
+            struct epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.u64 = static_cast<std::uint64_t>(pid);
+            if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) == -1)
+            {
+                close(fd);
+                throw error(invalid_child);
+            }
+            // a child that exited before it was registered has already had
+            // its SIGCHLD, so it has to be reaped here
+            const iterator found = _watchers.emplace(pid, watcher{fd, std::move(callback)}).first;
+            if (settle(found, done) == -1)
+            {
+                forget(found);
+                throw error(invalid_child);
+            }
+#endif
+        }
+        else
+        {
+            const std::unordered_map<pid_t, sigfn::child_exit>::iterator found = _unclaimed.find(pid);
+            if (found != _unclaimed.end())
+            {
+                done.emplace_back(std::move(callback), found->second);
+                _unclaimed.erase(found);
+                _unclaimed_order.erase(std::find(_unclaimed_order.begin(), _unclaimed_order.end(), pid));
+            }
+            else
+            {
+                siginfo_t info = {};
+                if (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT) == -1)
+                {
+                    throw error(invalid_child);
+                }
+                int status;
+                struct rusage usage;
+                if (info.si_pid != 0 && wait4(pid, &status, WNOHANG, &usage) == pid)
+                {
+                    // exited before any SIGCHLD reached a watcher, reaped here like with pidfds
+                    done.emplace_back(std::move(callback), make_exit(pid, status, usage));
+                }
+                else
+                {
+                    _watchers.emplace(pid, watcher{-1, std::move(callback)});
+                }
+            }
+        }
+    }
+    run(done);
+}
+
+bool sigfn::internal::child_registry::unwatch(pid_t pid)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const iterator found = _watchers.find(pid);
+    const bool watched = (found != _watchers.end());
+    if (watched)
+    {
+        forget(found);
+    }
+    return watched;
+}
+
+std::size_t sigfn::internal::child_registry::reap()
+{
+    completions done;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (_epoll >= 0)
+        {
+#ifdef SIGFN_PIDFD
+            struct epoll_event events[reap_batch];
+            int ready;
+            std::size_t settled;
+            do
+            {
+                ready = epoll_wait(_epoll, events, reap_batch, 0);
+                settled = 0;
+                for (int index = 0; index < ready; index++)
+                {
+                    const iterator found = _watchers.find(static_cast<pid_t>(events[index].data.u64));
+                    if (found != _watchers.end())
+                    {
+                        const int result = settle(found, done);
+                        if (result == -1)
+                        {
+                            // reaped by someone else, there is no status to report
+                            forget(found);
+                        }
+                        settled += (result != 0) ? 1 : 0;
+                    }
+                }
+            } while (ready == reap_batch && settled > 0);
+#endif
+        }
+        else
+        {
+            int status;
+            struct rusage usage;
+            pid_t pid;
+            while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0)
+            {
+                const iterator found = _watchers.find(pid);
+                if (found != _watchers.end())
+                {
+                    done.emplace_back(std::move(found->second.callback), make_exit(pid, status, usage));
+                    _watchers.erase(found);
+                }
+                else
+                {
+                    if (_unclaimed.count(pid) == 0)
+                    {
+                        _unclaimed_order.push_back(pid);
+                    }
+                    _unclaimed[pid] = make_exit(pid, status, usage);
+                    if (_unclaimed_order.size() > unclaimed_capacity)
+                    {
+                        _unclaimed.erase(_unclaimed_order.front());
+                        _unclaimed_order.pop_front();
+                    }
+                }
+            }
+        }
+    }
+    run(done);
+    return done.size();
+}
+
+std::size_t sigfn::internal::child_registry::size() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _watchers.size();
+}
+
+int sigfn::internal::child_registry::settle(iterator found, completions &done)
+{
+    int result(0);
+#ifdef SIGFN_PIDFD
+    siginfo_t info;
+    struct rusage usage;
+    if (pidfd_wait(found->second.fd, info, usage) == -1)
+    {
+        result = -1;
+    }
+    else if (info.si_pid != 0)
+    {
+        sigfn::child_exit exit = {};
+        exit.pid = info.si_pid;
+        exit.code = info.si_code;
+        exit.status = info.si_status;
+        exit.usage = usage;
+        done.emplace_back(std::move(found->second.callback), exit);
+        forget(found);
+        result = 1;
+    }
+#else
+    static_cast<void>(found);
+    static_cast<void>(done);
+#endif
+    return result;
+}
+
+void sigfn::internal::child_registry::forget(iterator found)
+{
+#ifdef SIGFN_PIDFD
+    if (found->second.fd >= 0)
+    {
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, found->second.fd, nullptr);
+        close(found->second.fd);
+    }
+#endif
+    _watchers.erase(found);
+}
+
+void sigfn::internal::child_registry::run(completions &done)
+{
+    for (std::pair<sigfn::child_watcher::exit_function, sigfn::child_exit> &completion : done)
+    {
+        try
+        {
+            completion.first(completion.second);
+        }
+        catch (...)
+        {
+            // children are independent, one throwing callback must not lose the other exits
+        }
+    }
+}
+
+sigfn::child_watcher::child_watcher() : _registry(std::make_shared<internal::child_registry>())
+{
+    const std::shared_ptr<internal::child_registry> registry = _registry;
+    _token = sigfn::attach_deferred(
+        SIGCHLD,
+        [registry](int)
+        {
+            registry->reap();
+        });
+}
+
+sigfn::child_watcher::~child_watcher()
+{
+    sigfn::detach(_token);
+}
+
+void sigfn::child_watcher::watch(pid_t pid, exit_function callback)
+{
+    _registry->watch(pid, std::move(callback));
+}
+
+bool sigfn::child_watcher::unwatch(pid_t pid)
+{
+    return _registry->unwatch(pid);
+}
+
+std::size_t sigfn::child_watcher::reap()
+{
+    return _registry->reap();
+}
+
+std::size_t sigfn::child_watcher::size() const
+{
+    return _registry->size();
+}
+
+bool sigfn::child_watcher::uses_pidfd() const
+{
+    return _registry->pidfd();
+}
+#endif
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <ctime>
+#include <ucontext.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define SIGFN_BACKTRACE
+#endif
+#endif
+
+namespace
+{
+    constexpr std::size_t crash_stack_size = 64 * 1024;
+
+    // alternate signal stack of the calling thread, so a stack overflow can
+    // still be reported; released when the thread exits
+    struct alternate_stack
+    {
+        ~alternate_stack()
+        {
+            if (memory)
+            {
+                stack_t disabled = {};
+                disabled.ss_flags = SS_DISABLE;
+                sigaltstack(&disabled, nullptr);
+            }
+        }
+
+        std::unique_ptr<char[]> memory;
+    };
+
+    thread_local alternate_stack crash_stack;
+
+    const char *signal_name(int signum)
+    {
+        const char *name("signal");
+        switch (signum)
+        {
+        case SIGSEGV:
+            name = "SIGSEGV";
+            break;
+        case SIGBUS:
+            name = "SIGBUS";
+            break;
+        case SIGFPE:
+            name = "SIGFPE";
+            break;
+        case SIGILL:
+            name = "SIGILL";
+            break;
+        case SIGABRT:
+            name = "SIGABRT";
+            break;
+        default:
+            break;
+        }
+        return name;
+    }
+
+    void write_integer(sigfn::internal::fd_writer &out, std::int64_t value)
+    {
+        if (value < 0)
+        {
+            out.text("-");
+            out.number(static_cast<std::uint64_t>(-value));
+        }
+        else
+        {
+            out.number(static_cast<std::uint64_t>(value));
+        }
+    }
+
+    void write_register(sigfn::internal::fd_writer &out, const char *name, std::uint64_t value)
+    {
+        out.text(" ");
+        out.text(name);
+        out.text("=");
+        out.hex(value);
+    }
+
+    void write_registers(sigfn::internal::fd_writer &out, const void *context)
+    {
+#if defined(__linux__) && defined(__x86_64__)
+        static const char *const names[] = {"rip", "rsp", "rbp", "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"};
+        static const int indices[] = {REG_RIP, REG_RSP, REG_RBP, REG_RAX, REG_RBX, REG_RCX, REG_RDX, REG_RSI, REG_RDI, REG_R8, REG_R9, REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15};
+        const greg_t *const registers = static_cast<const ucontext_t *>(context)->uc_mcontext.gregs;
+        out.text("registers:");
+        for (std::size_t index = 0; index < sizeof(indices) / sizeof(indices[0]); index++)
+        {
+            write_register(out, names[index], static_cast<std::uint64_t>(registers[indices[index]]));
+        }
+        out.text("\n");
+#elif defined(__linux__) && defined(__aarch64__)
+        static const char *const names[] = {"x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15", "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23", "x24", "x25", "x26", "x27", "x28", "fp", "lr"};
+        const mcontext_t &machine = static_cast<const ucontext_t *>(context)->uc_mcontext;
+        out.text("registers:");
+        write_register(out, "pc", machine.pc);
+        write_register(out, "sp", machine.sp);
+        for (std::size_t index = 0; index < sizeof(names) / sizeof(names[0]); index++)
+        {
+            write_register(out, names[index], machine.regs[index]);
+        }
+        out.text("\n");
+#else
+        static_cast<void>(out);
+        static_cast<void>(context);
+#endif
+    }
+}
+
+void sigfn::internal::crash_reporter::install(int fd, const int *signums, std::size_t count)
+{
+    if (fd < 0)
+    {
+        throw error(invalid_crash);
+    }
+    if (signums == nullptr || count == 0)
+    {
+        throw error(empty_sigset);
+    }
+    for (std::size_t index = 0; index < count; index++)
+    {
+        if (signums[index] <= 0 || signums[index] >= signal_count)
+        {
+            throw error(invalid_signum);
+        }
+    }
+#ifdef SIGFN_BACKTRACE
+    // the first backtrace() loads the unwinder, which may allocate; do it
+    // here rather than in a crashing process
+    static_cast<void>(backtrace(_frames, frame_capacity));
+#endif
+    thread_init();
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _fd.store(fd);
+    for (std::size_t index = 0; index < count; index++)
+    {
+        const int signum = signums[index];
+        if (!_installed[signum].load())
+        {
+            struct sigaction action = {};
+            action.sa_sigaction = report;
+            action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            if (sigaction(signum, &action, &_previous[signum]) != 0)
+            {
+                throw error(invalid_syscall);
+            }
+            _installed[signum].store(true);
+        }
+    }
+}
+
+void sigfn::internal::crash_reporter::uninstall()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (int signum = 1; signum < signal_count; signum++)
+    {
+        if (_installed[signum].load())
+        {
+            sigaction(signum, &_previous[signum], nullptr);
+            _installed[signum].store(false);
+        }
+    }
+    _fd.store(-1);
+}
+
+void sigfn::internal::crash_reporter::thread_init()
+{
+    stack_t current = {};
+    // keep a stack installed by the thread itself or another library
+    if (!crash_stack.memory && sigaltstack(nullptr, &current) == 0 && (current.ss_flags & SS_DISABLE) != 0)
+    {
+        const std::size_t size = std::max<std::size_t>(crash_stack_size, SIGSTKSZ);
+        std::unique_ptr<char[]> memory(new char[size]);
+        stack_t stack = {};
+        stack.ss_sp = memory.get();
+        stack.ss_size = size;
+        if (sigaltstack(&stack, nullptr) != 0)
+        {
+            throw error(invalid_syscall);
+        }
+        crash_stack.memory = std::move(memory);
+    }
+}
+
+void sigfn::internal::crash_reporter::report(int signum, siginfo_t *info, void *context)
+{
+    crash_reporter &reporter = state::crashes;
+    const int fd = reporter._fd.load();
+    if (fd >= 0 && !reporter._reporting.exchange(true))
+    {
+        reporter.write_report(fd, signum, info, context);
+        reporter._reported.store(true);
+    }
+    else
+    {
+        // another thread is reporting; give it a bounded time to finish
+        // before the default action takes the process down
+        const struct timespec pause = {0, 1000000};
+        for (int attempt = 0; attempt < 1000 && fd >= 0 && !reporter._reported.load(); attempt++)
+        {
+            nanosleep(&pause, nullptr);
+        }
+    }
+    reporter.chain(signum, info);
+}
+
+void sigfn::internal::crash_reporter::write_report(int fd, int signum, const siginfo_t *info, void *context)
+{
+    fd_writer out(fd);
+    out.text("*** sigfn: fatal signal ");
+    out.number(static_cast<std::uint64_t>(signum));
+    out.text(" (");
+    out.text(signal_name(signum));
+    out.text(") code ");
+    write_integer(out, (info != nullptr) ? info->si_code : 0);
+    out.text(" address ");
+    out.hex((info != nullptr) ? reinterpret_cast<std::uintptr_t>(info->si_addr) : 0);
+    out.text("\npid ");
+    out.number(static_cast<std::uint64_t>(getpid()));
+    out.text(" tid ");
+    out.number(static_cast<std::uint64_t>(thread_id()));
+    out.text("\n");
+    if (context != nullptr)
+    {
+        write_registers(out, context);
+    }
+#ifdef SIGFN_BACKTRACE
+    const int depth = backtrace(_frames, frame_capacity);
+    out.text("backtrace:\n");
+    out.flush();
+    backtrace_symbols_fd(_frames, depth, fd);
+#endif
+    out.text("*** end of report\n");
+    out.flush();
+}
+
+void sigfn::internal::crash_reporter::chain(int signum, const siginfo_t *info)
+{
+    const struct sigaction &previous = _previous[signum];
+    bool handled(false);
+    if ((previous.sa_flags & SA_SIGINFO) != 0)
+    {
+        handled = (previous.sa_sigaction != nullptr);
+    }
+    else
+    {
+        handled = (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN && previous.sa_handler != nullptr);
+    }
+    if (!handled)
+    {
+        // nothing to hand the signal to: it is blocked until this handler
+        // returns, so the raise is delivered with the default action right
+        // after
+        struct sigaction fallback = {};
+        fallback.sa_handler = SIG_DFL;
+        sigemptyset(&fallback.sa_mask);
+        sigaction(signum, &fallback, nullptr);
+        raise(signum);
+        return;
+    }
+    // the previous handler may recover, for instance by mapping the faulting
+    // page, so it gets the signal as if this handler had never been
+    // installed; a fault raised by the kernel traps again into it once the
+    // instruction restarts, any other signal is raised again
+    sigaction(signum, &previous, nullptr);
+    _installed[signum].store(false);
+    const bool fault = (signum == SIGSEGV || signum == SIGBUS || signum == SIGILL || signum == SIGFPE);
+    if (!fault || info == nullptr || info->si_code <= 0)
+    {
+        raise(signum);
+    }
+}
+
+void sigfn::crash_install(int fd, std::initializer_list<int> signums)
+{
+    internal::state::crashes.install(fd, signums.begin(), signums.size());
+}
+
+void sigfn::crash_install(int fd, const int *signums, std::size_t count)
+{
+    internal::state::crashes.install(fd, signums, count);
+}
+
+void sigfn::crash_thread_init()
+{
+    internal::crash_reporter::thread_init();
+}
+
+void sigfn::crash_uninstall()
+{
+    internal::state::crashes.uninstall();
+}
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+sigfn::internal::dispatcher::~dispatcher()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_thread.joinable())
+    {
+        _stopping = true;
+        wake();
+        _thread.join();
+    }
+#ifndef _WIN32
+    const int read_fd = _wake_read.exchange(-1);
+    const int write_fd = _wake_write.exchange(-1);
+    if (write_fd >= 0 && write_fd != read_fd)
+    {
+        close(write_fd);
+    }
+    if (read_fd >= 0)
+    {
+        close(read_fd);
+    }
+#endif
+}
+
+void sigfn::internal::dispatcher::start()
+{
+#ifdef _WIN32
+    throw error(unsupported);
+#else
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_thread.joinable())
+    {
+        int fds[2];
+#ifdef __linux__
+        fds[0] = eventfd(0, EFD_CLOEXEC);
+        fds[1] = fds[0];
+        if (fds[0] < 0)
+        {
+            throw error(invalid_dispatcher);
+        }
+#else
+        if (pipe(fds) != 0)
+        {
+            throw error(invalid_dispatcher);
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        // a full pipe already guarantees a wakeup, so writers never block
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+#endif
+        _wake_read = fds[0];
+        _wake_write = fds[1];
+        // the dispatcher inherits a full mask so it never steals signals
+        // from threads waiting on them
+        sigset_t blocked;
+        sigset_t previous;
+        sigfillset(&blocked);
+        pthread_sigmask(SIG_SETMASK, &blocked, &previous);
+        try
+        {
+            _thread = std::thread(&dispatcher::run, this);
+        }
+        catch (...)
+        {
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+            throw;
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    }
+#endif
+}
+
+bool sigfn::internal::dispatcher::notify(int signum)
+{
+    const std::uint64_t bit = std::uint64_t(1) << (signum % 64);
+    const bool first = (_pending[signum / 64].fetch_or(bit) & bit) == 0;
+    wake();
+    return first;
+}
+
+void sigfn::internal::dispatcher::wake()
+{
+#ifndef _WIN32
+    const int fd = _wake_write.load();
+    if (fd >= 0)
+    {
+        const std::uint64_t value(1);
+        const ssize_t result = write(fd, &value, sizeof(value));
+        static_cast<void>(result);
+    }
+#endif
+}
+
+void sigfn::internal::dispatcher::run()
+{
+#ifndef _WIN32
+    const std::chrono::steady_clock::time_point idle = std::chrono::steady_clock::time_point::max();
+    struct pollfd descriptor = {_wake_read.load(), POLLIN, 0};
+    int timeout(-1);
+    _armed.fill(idle);
+    while (!_stopping)
+    {
+        if (poll(&descriptor, 1, timeout) > 0)
+        {
+            std::uint64_t buffer[8];
+            const ssize_t result = read(descriptor.fd, buffer, sizeof(buffer));
+            static_cast<void>(result);
+        }
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (int word = 0; word < pending_words; word++)
+        {
+            const std::uint64_t bits = _pending[word].exchange(0);
+            for (int bit = 0; bits != 0 && bit < 64; bit++)
+            {
+                if ((bits & (std::uint64_t(1) << bit)) != 0 && _armed[word * 64 + bit] == idle)
+                {
+                    _armed[word * 64 + bit] = now;
+                }
+            }
+        }
+        std::chrono::steady_clock::time_point next = idle;
+        for (int signum = 1; signum < signal_count; signum++)
+        {
+            if (_armed[signum] != idle)
+            {
+                std::optional<std::chrono::steady_clock::time_point> deadline;
+                try
+                {
+                    deadline = state::handler_table.dispatch(signum, _armed[signum]);
+                }
+                catch (...)
+                {
+                    // a throwing handler must not take the dispatcher down with it
+                }
+                if (deadline.has_value())
+                {
+                    next = std::min(next, deadline.value());
+                }
+                else
+                {
+                    _armed[signum] = idle;
+                }
+            }
+        }
+        timeout = -1;
+        if (next != idle)
+        {
+            // round up so a held batch is never polled for before it is due
+            const std::chrono::steady_clock::duration remaining = next - std::chrono::steady_clock::now();
+            const std::chrono::milliseconds milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(remaining + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+            timeout = static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(milliseconds.count(), 0, std::numeric_limits<int>::max()));
+        }
+    }
+#endif
+}
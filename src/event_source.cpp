@@ -0,0 +1,157 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#ifdef __linux__
+#include <sys/signalfd.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+namespace
+{
+    // signalfd reports a flattened record, so rebuild the siginfo_t that a
+    // handler installed with SA_SIGINFO would have seen
+    siginfo_t make_siginfo(const struct signalfd_siginfo &record)
+    {
+        siginfo_t info = {};
+        info.si_signo = static_cast<int>(record.ssi_signo);
+        info.si_errno = record.ssi_errno;
+        info.si_code = record.ssi_code;
+        switch (info.si_signo)
+        {
+        case SIGSEGV:
+        case SIGBUS:
+        case SIGILL:
+        case SIGFPE:
+            info.si_addr = reinterpret_cast<void *>(static_cast<std::uintptr_t>(record.ssi_addr));
+            break;
+        case SIGCHLD:
+            info.si_pid = static_cast<pid_t>(record.ssi_pid);
+            info.si_uid = static_cast<uid_t>(record.ssi_uid);
+            info.si_status = record.ssi_status;
+            break;
+        default:
+            info.si_pid = static_cast<pid_t>(record.ssi_pid);
+            info.si_uid = static_cast<uid_t>(record.ssi_uid);
+            info.si_value.sival_ptr = reinterpret_cast<void *>(static_cast<std::uintptr_t>(record.ssi_ptr));
+            break;
+        }
+        return info;
+    }
+}
+#endif
+
+sigfn::event_source::event_source(std::initializer_list<int> signums) : event_source(signums.begin(), signums.size())
+{
+}
+
+sigfn::event_source::event_source(const int *signums, std::size_t count) : _fd(-1)
+{
+#ifdef __linux__
+    sigset_t mask;
+    if (signums == nullptr || count == 0)
+    {
+        throw internal::error(internal::empty_sigset);
+    }
+    sigemptyset(&mask);
+    for (std::size_t index = 0; index < count; index++)
+    {
+        if (sigaddset(&mask, signums[index]) != 0)
+        {
+            throw internal::error(internal::invalid_signum);
+        }
+    }
+    // signals must be blocked or they are delivered to their handlers instead
+    sigset_t previous;
+    if (pthread_sigmask(SIG_BLOCK, &mask, &previous) != 0)
+    {
+        throw internal::error(internal::invalid_source);
+    }
+    // signals the thread had already blocked stay blocked afterwards
+    sigset_t restore;
+    sigemptyset(&restore);
+    for (std::size_t index = 0; index < count; index++)
+    {
+        if (sigismember(&previous, signums[index]) == 0)
+        {
+            sigaddset(&restore, signums[index]);
+            _restore.push_back(signums[index]);
+        }
+    }
+    _fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (_fd < 0)
+    {
+        pthread_sigmask(SIG_UNBLOCK, &restore, nullptr);
+        throw internal::error(internal::invalid_source);
+    }
+#else
+    static_cast<void>(signums);
+    static_cast<void>(count);
+    throw internal::error(internal::unsupported);
+#endif
+}
+
+sigfn::event_source::~event_source()
+{
+#ifdef __linux__
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signum : _restore)
+    {
+        sigaddset(&mask, signum);
+    }
+    close(_fd);
+    pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+#endif
+}
+
+int sigfn::event_source::fd() const
+{
+    return _fd;
+}
+
+std::size_t sigfn::event_source::dispatch()
+{
+    std::size_t dispatched(0);
+#ifdef __linux__
+    struct signalfd_siginfo batch[16];
+    ssize_t result;
+    do
+    {
+        result = read(_fd, batch, sizeof(batch));
+        if (result > 0)
+        {
+            const std::size_t count = static_cast<std::size_t>(result) / sizeof(batch[0]);
+            for (std::size_t index = 0; index < count; index++)
+            {
+                const siginfo_t info = make_siginfo(batch[index]);
+                internal::state::statistics.delivered(info.si_signo);
+                internal::state::handler_table.invoke(info.si_signo, &info);
+            }
+            dispatched += count;
+        }
+    } while (result == static_cast<ssize_t>(sizeof(batch)));
+#endif
+    return dispatched;
+}
@@ -26,10 +26,32 @@
 #include <sigfn.h>
 #include <sigfn.hpp>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
 #include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #ifdef _WIN32
 typedef void (*__sighandler_t)(int);
+typedef struct
+{
+    int si_signo;
+} siginfo_t;
+#endif
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define SIGFN_SIGTIMEDWAIT
+#define SIGFN_POSIX_TIMERS
 #endif
 
 namespace sigfn
@@ -40,18 +62,1213 @@ namespace sigfn
         const std::string invalid_handler = "sigfn: invalid handler";
         const std::string empty_sigset = "sigfn: empty signum set";
         const std::string invalid_timeval = "sigfn: invalid timeval";
+        const std::string invalid_signum = "sigfn: invalid signal number";
+        const std::string unsupported = "sigfn: unsupported on this platform";
+        const std::string invalid_dispatcher = "sigfn: failed to start dispatcher";
+        const std::string invalid_source = "sigfn: invalid event source";
+        const std::string invalid_wait = "sigfn: sigtimedwait() failed";
+        const std::string invalid_realtime = "sigfn: not a realtime signal";
+        const std::string invalid_capacity = "sigfn: invalid capacity";
+        const std::string invalid_queue = "sigfn: invalid realtime queue";
+        const std::string pool_exhausted = "sigfn: handler pool exhausted";
+        const std::string invalid_stats = "sigfn: invalid stats";
+        const std::string invalid_format = "sigfn: invalid trace format";
+        const std::string invalid_pool = "sigfn: invalid thread pool";
+        const std::string invalid_priority = "sigfn: invalid priority";
+        const std::string invalid_trace = "sigfn: failed to write trace";
+        const std::string invalid_token = "sigfn: invalid handler token";
+        const std::string chain_full = "sigfn: handler chain full";
+        const std::string invalid_stop = "sigfn: invalid stop source";
+        const std::string invalid_shutdown = "sigfn: invalid shutdown";
+        const std::string invalid_rate = "sigfn: invalid rate limit";
+        const std::string invalid_child = "sigfn: invalid child process";
+        const std::string invalid_watcher = "sigfn: invalid child watcher";
+        const std::string invalid_timer = "sigfn: invalid timer";
+        const std::string invalid_interrupter = "sigfn: invalid thread interrupter";
+        const std::string thread_registered = "sigfn: thread already registered";
+        const std::string invalid_crash = "sigfn: invalid crash report descriptor";
+        const std::string invalid_profiler = "sigfn: invalid profiler";
+        const std::string profiler_running = "sigfn: another profiler is running";
+        const std::string invalid_profile = "sigfn: failed to write profile";
+        const std::string invalid_sigpipe = "sigfn: invalid sigpipe guard";
+
+        // Exception carrying one of the static messages above. Unlike
+        // std::runtime_error it never copies the message onto the heap.
+        class error : public std::exception
+        {
+        public:
+            explicit error(const std::string &message) noexcept : _message(message.c_str())
+            {
+            }
+
+            const char *what() const noexcept override
+            {
+                return _message;
+            }
+
+        private:
+            const char *_message;
+        };
+
+        // one slot per signal number, indexed directly by signum
+        constexpr int signal_count = NSIG;
+
+        // CLOCK_MONOTONIC in nanoseconds, async-signal-safe
+        inline std::uint64_t monotonic_ns()
+        {
+#ifdef _WIN32
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + static_cast<std::uint64_t>(now.tv_nsec);
+#endif
+        }
+
+#ifndef SIGFN_ENTRY_CAPACITY
+#define SIGFN_ENTRY_CAPACITY 256
+#endif
+        // live plus retired handler entries available without the heap
+        constexpr std::size_t entry_capacity = SIGFN_ENTRY_CAPACITY;
+
+#ifndef SIGFN_CHAIN_CAPACITY
+#define SIGFN_CHAIN_CAPACITY 16
+#endif
+        // handlers that can be attached to a single signal
+        constexpr std::size_t chain_capacity = SIGFN_CHAIN_CAPACITY;
+
+        enum class dispatch_mode
+        {
+            immediate,
+            deferred,
+            coalesced,
+            polled
+        };
+
+        struct handler_entry
+        {
+            explicit handler_entry(sigfn::handler_function function, dispatch_mode mode = dispatch_mode::immediate)
+                : function(std::move(function)), mode(mode)
+            {
+            }
+
+            // a polled entry has no function, deliveries only mark the signal pending
+            explicit handler_entry(dispatch_mode mode) : mode(mode)
+            {
+            }
+
+            handler_entry(sigfn::handler_function function, worker_pool *pool, sigfn::priority level)
+                : function(std::move(function)), mode(dispatch_mode::deferred), pool(pool), level(level)
+            {
+            }
+
+#ifndef _WIN32
+            explicit handler_entry(sigfn::info_handler_function info_function)
+                : mode(dispatch_mode::immediate), info_function(std::move(info_function))
+            {
+            }
+#endif
+
+            handler_entry(sigfn::batch_function batch_function, std::chrono::steady_clock::duration window, std::uint64_t threshold)
+                : mode(dispatch_mode::coalesced), batch_function(std::move(batch_function)), window(window), threshold(threshold)
+            {
+            }
+
+            sigfn::handler_function function;
+            dispatch_mode mode;
+#ifndef _WIN32
+            sigfn::info_handler_function info_function;
+#endif
+            sigfn::batch_function batch_function;
+            std::chrono::steady_clock::duration window = std::chrono::steady_clock::duration::zero();
+            std::uint64_t threshold = 0;
+            std::atomic<std::uint64_t> count{0};
+            // set when a deferred handler runs on a thread pool
+            worker_pool *pool = nullptr;
+            sigfn::priority level = sigfn::priority::normal;
+
+            // intrusive retirement list, owned by the dispatch table
+            handler_entry *retired_next = nullptr;
+            std::uint64_t retired_epoch = 0;
+
+#ifdef SIGFN_NO_HEAP
+            // entries come from a fixed pool instead of the heap
+            static void *operator new(std::size_t size);
+            static void operator delete(void *pointer) noexcept;
+#endif
+
+            // info is null when the delivery did not come with a siginfo_t
+            void invoke(int signum, const siginfo_t *info) const;
+        };
+
+        // Immutable array of the handlers attached to one signal. Attaching or
+        // detaching publishes a modified copy, so delivery walks a chain
+        // without locking and a chain is retired like a handler entry.
+        struct handler_chain
+        {
+            struct link
+            {
+                std::uint64_t token = 0;
+                handler_entry *entry = nullptr;
+            };
+
+            std::size_t size = 0;
+            // set when any link runs on the dispatcher thread
+            bool deferred = false;
+            std::array<link, chain_capacity> links{};
+
+            handler_chain *retired_next = nullptr;
+            std::uint64_t retired_epoch = 0;
+
+#ifdef SIGFN_NO_HEAP
+            static void *operator new(std::size_t size);
+            static void operator delete(void *pointer) noexcept;
+#endif
+        };
+
+        // Lock-free dispatch table. Delivery loads a slot and calls through it,
+        // while registration swaps slots under a writer lock and retires the old
+        // entries. Retired entries are reclaimed once every reader that could
+        // have observed them has left its epoch.
+        class dispatch_table
+        {
+        public:
+            dispatch_table() = default;
+            dispatch_table(const dispatch_table &) = delete;
+            dispatch_table &operator=(const dispatch_table &) = delete;
+            ~dispatch_table();
+
+            void store(int signum, handler_entry *entry);
+
+            // appends an entry to the chain of the signal, returns its token
+            std::uint64_t attach(int signum, handler_entry *entry);
+
+            // returns false if the token is not attached
+            bool detach(std::uint64_t token);
+
+            // drops the handler and every attached handler of the signal
+            void clear(int signum);
+
+#ifndef _WIN32
+            // Replaces the handler of the signal like store, but keeps the
+            // replaced handler and disposition so unclaim can give them back.
+            // Returns the claim token.
+            std::uint64_t claim(int signum, handler_entry *entry, int flags);
+
+            // Restores what the claim replaced, unless the signal was
+            // registered again since. A signal that was at SIG_DFL keeps the
+            // sigfn handler with an empty slot, since a realtime signal that
+            // is still queued or arrives late would otherwise terminate the
+            // process. Returns false if the token is not a claim.
+            bool unclaim(std::uint64_t token);
+#endif
+
+            // called in signal context, runs or defers the handler
+            void deliver(int signum, const siginfo_t *info);
+
+            // Called on the dispatcher thread, runs deferred handlers and
+            // flushes coalesced batches. Returns the time at which a batch
+            // armed at the given time must be flushed if it is still held.
+            std::optional<std::chrono::steady_clock::time_point> dispatch(int signum, const std::chrono::steady_clock::time_point &armed);
+
+            // called outside of signal context, runs any handler
+            void invoke(int signum, const siginfo_t *info);
+
+            // called on a pool worker, runs the handler if it is still deferred to the pool
+            void run(int signum, const worker_pool *pool);
+
+            // resets every signal still deferred to the pool to its default action
+            void release(const worker_pool *pool);
+
+            // Stops and frees a pool whose signals were released. Waits like
+            // synchronize, unless the calling thread is inside a delivery
+            // itself; the pool is then freed by a later reclaim.
+            void discard(worker_pool *pool);
+
+            // blocks until every delivery in progress has left the table
+            void synchronize();
+
+            // frees retired entries that no reader can still observe
+            void collect();
+
+        private:
+            // runs the handlers of a delivery that passed the rate limit
+            void forward(int signum, const siginfo_t *info);
+            void retire(handler_entry *entry);
+            void retire(handler_chain *chain);
+            void retire(worker_pool *pool);
+            void reclaim();
+
+            std::array<std::atomic<handler_entry *>, signal_count> _slots{};
+            std::array<std::atomic<handler_chain *>, signal_count> _chains{};
+            // set when a deferred chain is waiting for the dispatcher
+            std::array<std::atomic<bool>, signal_count> _chain_pending{};
+            std::atomic<std::uint64_t> _epoch{0};
+            std::array<std::atomic<std::uint64_t>, 2> _readers{};
+            std::mutex _mutex;
+            handler_entry *_retired = nullptr;
+            handler_chain *_retired_chains = nullptr;
+            worker_pool *_retired_pools = nullptr;
+            std::uint64_t _serial = 0;
+#ifndef _WIN32
+            struct claim_record
+            {
+                handler_entry *entry;
+                // held out of the slot, not retired, until the claim ends
+                handler_entry *replaced;
+                struct sigaction previous;
+            };
+
+            std::unordered_map<std::uint64_t, claim_record> _claims;
+#endif
+        };
+
+        // Runs deferred handlers on a sigfn-owned thread. The signal handler
+        // only sets a pending bit and writes to a wakeup descriptor, both of
+        // which are async-signal-safe.
+        class dispatcher
+        {
+        public:
+            static constexpr int pending_words = (signal_count + 63) / 64;
+
+            dispatcher() = default;
+            dispatcher(const dispatcher &) = delete;
+            dispatcher &operator=(const dispatcher &) = delete;
+            ~dispatcher();
+
+            void start();
+
+            // returns false if the signal was already pending
+            bool notify(int signum);
+
+        private:
+            void run();
+            void wake();
+
+            std::array<std::atomic<std::uint64_t>, pending_words> _pending{};
+            // dispatcher thread only, time each held batch was armed
+            std::array<std::chrono::steady_clock::time_point, signal_count> _armed;
+            std::atomic<int> _wake_read{-1};
+            std::atomic<int> _wake_write{-1};
+            std::atomic<bool> _stopping{false};
+            std::mutex _mutex;
+            std::thread _thread;
+        };
+
+        // Shared signal source behind the coroutine awaitables. Each signal
+        // gets one deferred handler that completes every waiter registered
+        // for it, and a single timer thread expires the waiters that have a
+        // deadline, so no waiter owns a thread.
+        class async_registry
+        {
+        public:
+            async_registry() = default;
+            async_registry(const async_registry &) = delete;
+            async_registry &operator=(const async_registry &) = delete;
+            ~async_registry();
+
+            void subscribe(async_waiter *waiter, const int *signums, std::size_t count, const std::optional<std::chrono::steady_clock::time_point> &deadline);
+            void unsubscribe(async_waiter *waiter);
+
+            // called on the dispatcher thread
+            void fire(int signum);
+
+        private:
+            typedef std::multimap<std::chrono::steady_clock::time_point, async_waiter *> deadline_map;
+
+            struct subscription
+            {
+                std::vector<int> signums;
+                std::optional<deadline_map::iterator> deadline;
+            };
+
+            void remove(async_waiter *waiter);
+            // takes the resume tasks of waiters already removed and marked completing
+            void finish(const std::vector<async_waiter *> &ready, int signum, std::unique_lock<std::mutex> &lock);
+            // detaches the handler of the signal once nobody waits on it
+            void release(int signum);
+            void run();
+
+            std::mutex _mutex;
+            std::condition_variable _changed;
+            std::unordered_map<async_waiter *, subscription> _subscriptions;
+            // removed waiters whose complete is still running, unsubscribe waits for them
+            std::unordered_set<async_waiter *> _completing;
+            std::condition_variable _completed;
+            std::array<std::unordered_set<async_waiter *>, signal_count> _waiting;
+            // token of the handler attached to each signal, 0 if none
+            std::array<handler_token, signal_count> _tokens{};
+            deadline_map _deadlines;
+            bool _stopping = false;
+            std::thread _timer;
+        };
+
+        // State shared by a stop_source, its tokens and its callbacks. The flag
+        // is set in signal context; the callbacks run and the stoppable waits
+        // are woken once, under the mutex, by the first notify().
+        class stop_state
+        {
+        public:
+            explicit stop_state(std::vector<int> signums) : signums(std::move(signums))
+            {
+            }
+
+            stop_state(const stop_state &) = delete;
+            stop_state &operator=(const stop_state &) = delete;
+
+            // called in signal context
+            void raise()
+            {
+                requested.store(true, std::memory_order_release);
+            }
+
+            // returns false if a stop was already requested
+            bool request();
+
+            // runs the callbacks and wakes the stoppable waits, once
+            void notify();
+
+            void add(sigfn::stop_callback *callback);
+            void remove(sigfn::stop_callback *callback);
+
+#ifdef SIGFN_SIGTIMEDWAIT
+            // returns false if the waits were already woken
+            bool enter(pthread_t thread);
+            void leave(pthread_t thread);
+#endif
+
+            const std::vector<int> signums;
+            std::atomic<bool> requested{false};
+
+        private:
+            std::mutex _mutex;
+            std::condition_variable _finished;
+            bool _notified = false;
+            std::vector<sigfn::stop_callback *> _callbacks;
+            const sigfn::stop_callback *_running = nullptr;
+            std::thread::id _runner;
+#ifdef SIGFN_SIGTIMEDWAIT
+            std::vector<pthread_t> _threads;
+#endif
+        };
+
+        // Components and signal bookkeeping behind sigfn::shutdown_orchestrator.
+        // Deliveries are counted in signal context; the dispatcher thread
+        // releases wait() on the first and escalates on the second.
+        class shutdown_state
+        {
+        public:
+            struct component
+            {
+                std::string name;
+                int stage;
+                std::chrono::steady_clock::duration timeout;
+                std::function<void()> drain;
+            };
+
+            explicit shutdown_state(sigfn::shutdown_orchestrator::escalate_function escalate) : _escalate(std::move(escalate))
+            {
+            }
+
+            shutdown_state(const shutdown_state &) = delete;
+            shutdown_state &operator=(const shutdown_state &) = delete;
+
+            // called in signal context
+            void delivered()
+            {
+                deliveries.fetch_add(1);
+            }
+
+            // called on the dispatcher thread
+            void signalled();
+
+            void add(component added);
+            void wait();
+            std::vector<sigfn::shutdown_timing> run();
+
+            std::atomic<std::uint64_t> deliveries{0};
+
+        private:
+            void escalate();
+
+            std::mutex _mutex;
+            std::condition_variable _signalled;
+            std::vector<component> _components;
+            std::mutex _run_mutex;
+            std::optional<std::vector<sigfn::shutdown_timing>> _report;
+            std::atomic<bool> _escalated{false};
+            const sigfn::shutdown_orchestrator::escalate_function _escalate;
+        };
+
+        // Workers behind sigfn::thread_pool. Every worker owns one deque per
+        // priority, each behind its own mutex; a worker pops its own deques
+        // from the back and, when they are empty, takes from the front of the
+        // others. Signals skip the deques and go through fixed per-priority
+        // queues. A signal is queued at most once: one that arrives while its
+        // handler is queued or running only marks it for a rerun, which keeps
+        // each handler serialized with itself.
+        class worker_pool
+        {
+        public:
+            explicit worker_pool(std::size_t workers);
+            worker_pool(const worker_pool &) = delete;
+            worker_pool &operator=(const worker_pool &) = delete;
+            ~worker_pool();
+
+            void post(std::function<void()> task, sigfn::priority level);
+
+            // called on the dispatcher thread
+            void schedule(int signum, sigfn::priority level);
+
+            std::size_t size() const;
+
+            // runs the queued work and joins the workers, idempotent
+            void stop();
+
+            worker_pool *retired_next = nullptr;
+            std::uint64_t retired_epoch = 0;
+
+        private:
+            static constexpr std::size_t priority_count = 3;
+
+            enum signal_state : int
+            {
+                idle,
+                scheduled,
+                rerun
+            };
+
+            struct worker
+            {
+                std::mutex mutex;
+                std::array<std::deque<std::function<void()>>, priority_count> queues;
+                std::thread thread;
+            };
+
+            // Signals waiting for a worker, guarded by _mutex. A signal is
+            // queued at most once, so signal_count entries never overflow and
+            // delivery does not allocate.
+            struct signal_queue
+            {
+                std::array<int, signal_count> signums{};
+                std::size_t head = 0;
+                std::size_t size = 0;
+            };
+
+            void enqueue(int signum, sigfn::priority level);
+            // takes a queued signal or, with signum left at 0, a posted task
+            bool take(std::size_t self, std::function<void()> &task, int &signum, sigfn::priority &level);
+            void run(std::size_t self);
+            void run_signal(int signum, sigfn::priority level);
+
+            std::vector<std::unique_ptr<worker>> _workers;
+            std::array<std::atomic<int>, signal_count> _signals{};
+            std::array<signal_queue, priority_count> _pending{};
+            std::atomic<std::size_t> _next{0};
+            std::mutex _mutex;
+            std::condition_variable _ready;
+            std::size_t _queued = 0;
+            bool _stopping = false;
+        };
+
+        // Bounded lock-free MPMC ring (Vyukov). Each cell carries a sequence
+        // number, so producers only contend on a single CAS and never wait on
+        // each other. push() is async-signal-safe, including when a handler
+        // interrupts another push on the same thread.
+        template <class T>
+        class bounded_queue
+        {
+        public:
+            explicit bounded_queue(std::size_t capacity) : _cells(round_up(capacity)), _mask(_cells.size() - 1)
+            {
+                for (std::size_t index = 0; index < _cells.size(); index++)
+                {
+                    _cells[index].sequence.store(index, std::memory_order_relaxed);
+                }
+            }
+
+            bool push(const T &value)
+            {
+                std::size_t position = _tail.load(std::memory_order_relaxed);
+                cell *target;
+                for (;;)
+                {
+                    target = &_cells[position & _mask];
+                    const std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+                    const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                    if (difference == 0)
+                    {
+                        if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (difference < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        position = _tail.load(std::memory_order_relaxed);
+                    }
+                }
+                target->value = value;
+                target->sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool pop(T &value)
+            {
+                std::size_t position = _head.load(std::memory_order_relaxed);
+                cell *target;
+                for (;;)
+                {
+                    target = &_cells[position & _mask];
+                    const std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+                    const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+                    if (difference == 0)
+                    {
+                        if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (difference < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        position = _head.load(std::memory_order_relaxed);
+                    }
+                }
+                value = target->value;
+                target->sequence.store(position + _mask + 1, std::memory_order_release);
+                return true;
+            }
+
+            std::size_t capacity() const
+            {
+                return _cells.size();
+            }
+
+        private:
+            struct cell
+            {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            static std::size_t round_up(std::size_t capacity)
+            {
+                std::size_t size(1);
+                while (size < capacity)
+                {
+                    size <<= 1;
+                }
+                return size;
+            }
+
+            std::vector<cell> _cells;
+            const std::size_t _mask;
+            alignas(64) std::atomic<std::size_t> _tail{0};
+            alignas(64) std::atomic<std::size_t> _head{0};
+        };
+
+        // Per-signal storm protection, enforced in the delivery path with
+        // atomics only. A token bucket and a throttle keep a single timestamp
+        // updated by CAS (the token bucket as a GCRA theoretical arrival
+        // time). A debounce holds deliveries until the signal has been quiet
+        // for the interval, and the dispatcher thread releases the trailing
+        // edge.
+        class rate_limiter
+        {
+        public:
+            enum class verdict
+            {
+                admitted,
+                suppressed,
+                // first delivery held by a debounce, the dispatcher must be woken
+                held,
+                // delivery folded into one already held by a debounce
+                folded
+            };
+
+            void token_bucket(int signum, std::uint64_t interval_ns, std::uint64_t burst);
+            void throttle(int signum, std::uint64_t interval_ns);
+            void debounce(int signum, std::uint64_t interval_ns);
+            void clear(int signum);
+
+            // called in signal context
+            verdict admit(int signum);
+
+            // Called on the dispatcher thread. Returns true once the trailing
+            // edge of a held debounce is due; otherwise sets remaining when a
+            // delivery is still held.
+            bool release(int signum, std::optional<std::chrono::nanoseconds> &remaining);
+
+        private:
+            enum policy : int
+            {
+                none,
+                bucket,
+                throttled,
+                debounced
+            };
+
+            struct alignas(64) limit
+            {
+                std::atomic<int> policy{none};
+                std::atomic<std::uint64_t> interval_ns{0};
+                std::atomic<std::uint64_t> burst{0};
+                std::atomic<std::uint64_t> stamp{0};
+                std::atomic<bool> held{false};
+            };
+
+            void configure(int signum, int policy, std::uint64_t interval_ns, std::uint64_t burst);
+
+            std::array<limit, signal_count> _limits;
+        };
+
+        // Per-signal delivery counters. Each signal owns its own cache lines,
+        // so deliveries of different signals never contend. Every update is a
+        // relaxed atomic and safe to call in signal context.
+        class stats_table
+        {
+        public:
+            void delivered(int signum);
+            void invoked(int signum, std::uint64_t nanoseconds);
+            void coalesced(int signum);
+            void dropped(int signum);
+            void suppressed(int signum);
+
+            sigfn::signal_stats snapshot(int signum) const;
+            void clear();
+
+        private:
+            struct alignas(64) counters
+            {
+                std::atomic<std::uint64_t> deliveries{0};
+                std::atomic<std::uint64_t> invocations{0};
+                std::atomic<std::uint64_t> handler_ns{0};
+                std::atomic<std::uint64_t> max_handler_ns{0};
+                std::atomic<std::uint64_t> coalesced{0};
+                std::atomic<std::uint64_t> dropped{0};
+                std::atomic<std::uint64_t> suppressed{0};
+                std::array<std::atomic<std::uint64_t>, histogram_buckets> histogram{};
+            };
+
+            std::array<counters, signal_count> _counters;
+        };
+
+        // Pending bits of the signals installed with sigfn::watch. Bit
+        // signum - 1 is set on delivery, so every signal fits in one word and
+        // a poll is a single exchange. The word owns its cache line.
+        static_assert(signal_count <= 65, "sigfn: signal numbers do not fit in a bitmap word");
+
+        class signal_bitmap
+        {
+        public:
+            // called in signal context
+            void set(int signum)
+            {
+                _bits.fetch_or(sigfn::signal_bit(signum), std::memory_order_release);
+            }
+
+            bool test(int signum) const
+            {
+                return (_bits.load(std::memory_order_relaxed) & sigfn::signal_bit(signum)) != 0;
+            }
+
+            std::uint64_t take()
+            {
+                return _bits.exchange(0, std::memory_order_acquire);
+            }
+
+        private:
+            alignas(64) std::atomic<std::uint64_t> _bits{0};
+        };
+
+#ifndef _WIN32
+        // id of the calling thread, cached per thread; async-signal-safe
+        pid_t thread_id();
+
+        // true if the thread is known to have exited, so per-thread state
+        // keyed by its id can be taken over; async-signal-safe
+        bool thread_exited(pid_t tid);
+
+        // Formats into a fixed buffer and flushes with write(2), so trace
+        // dumps and crash reports only make async-signal-safe calls.
+        class fd_writer
+        {
+        public:
+            explicit fd_writer(int fd) : _fd(fd)
+            {
+            }
+
+            void append(const void *data, std::size_t size);
+            void text(const char *string);
+            void number(std::uint64_t value);
+            void hex(std::uint64_t value);
+
+            // nanoseconds as fractional microseconds, the Chrome trace time unit
+            void microseconds(std::uint64_t nanoseconds);
+
+            bool flush();
+
+        private:
+            const int _fd;
+            char _buffer[512];
+            std::size_t _size = 0;
+            bool _failed = false;
+        };
+
+        // Per-thread trace rings. A thread claims a ring by its id and
+        // reserves a slot with a single fetch_add, so recording is wait-free
+        // even when a handler interrupts another recording on the same
+        // thread. Slots are published seqlock style for the dumper. The
+        // storage is allocated once and never freed, so a late delivery can
+        // never record into released memory.
+        class trace_buffer
+        {
+        public:
+            void start(std::size_t threads, std::size_t capacity);
+            void stop();
+
+            bool enabled() const
+            {
+                return _enabled.load(std::memory_order_acquire);
+            }
+
+            // called in signal context, timestamps of 0 are not applicable
+            void record(int signum, pid_t sender, std::uint64_t delivered, std::uint64_t entered, std::uint64_t exited);
+
+            // async-signal-safe, returns false if the descriptor rejected a write
+            bool dump(int fd, trace_format format) const;
+
+        private:
+            struct event
+            {
+                std::atomic<std::uint64_t> sequence{0};
+                std::atomic<int> signum{0};
+                std::atomic<pid_t> tid{0};
+                std::atomic<pid_t> sender{0};
+                std::atomic<std::uint64_t> delivered{0};
+                std::atomic<std::uint64_t> entered{0};
+                std::atomic<std::uint64_t> exited{0};
+            };
+
+            struct ring
+            {
+                std::atomic<pid_t> owner{0};
+                alignas(64) std::atomic<std::uint64_t> head{0};
+                event *events = nullptr;
+            };
+
+            ring *claim(pid_t tid);
+
+            std::mutex _mutex;
+            std::atomic<ring *> _rings{nullptr};
+            std::size_t _threads = 0;
+            std::size_t _capacity = 0;
+            std::atomic<bool> _enabled{false};
+            std::atomic<std::uint64_t> _dropped{0};
+        };
+
+        // sender of a user-originated signal, 0 for kernel-generated ones
+        inline pid_t sender_of(const siginfo_t *info)
+        {
+            return (info != nullptr && info->si_code <= 0) ? info->si_pid : 0;
+        }
+
+        class realtime_ring
+        {
+        public:
+            explicit realtime_ring(std::size_t capacity) : _queue(capacity)
+            {
+            }
+
+            // called in signal context
+            void push(const siginfo_t &info);
+
+            bool pop(sigfn::queued_signal &signal)
+            {
+                return _queue.pop(signal);
+            }
+
+            std::uint64_t overflows() const
+            {
+                return _overflows.load(std::memory_order_relaxed);
+            }
+
+        private:
+            bounded_queue<sigfn::queued_signal> _queue;
+            std::atomic<std::uint64_t> _overflows{0};
+        };
+
+        // Watched children of a sigfn::child_watcher, indexed by pid. With
+        // pidfds the epoll set reports which children exited, so a reap only
+        // touches those; otherwise wait4(-1) reaps every exited child and the
+        // ones nobody watches yet are parked in _unclaimed.
+        class child_registry
+        {
+        public:
+            child_registry();
+            child_registry(const child_registry &) = delete;
+            child_registry &operator=(const child_registry &) = delete;
+            ~child_registry();
+
+            void watch(pid_t pid, sigfn::child_watcher::exit_function callback);
+            bool unwatch(pid_t pid);
+
+            // called on the dispatcher thread
+            std::size_t reap();
+
+            std::size_t size() const;
+
+            bool pidfd() const
+            {
+                return _epoll >= 0;
+            }
+
+        private:
+            struct watcher
+            {
+                int fd;
+                sigfn::child_watcher::exit_function callback;
+            };
+
+            typedef std::unordered_map<pid_t, watcher>::iterator iterator;
+            typedef std::vector<std::pair<sigfn::child_watcher::exit_function, sigfn::child_exit>> completions;
+
+            int settle(iterator found, completions &done);
+            void forget(iterator found);
+            static void run(completions &done);
+
+            mutable std::mutex _mutex;
+            std::unordered_map<pid_t, watcher> _watchers;
+            std::unordered_map<pid_t, sigfn::child_exit> _unclaimed;
+            // pids of _unclaimed, oldest first
+            std::deque<pid_t> _unclaimed_order;
+            int _epoll;
+        };
+
+        // Logical timers of a sigfn::timer_wheel. Level L of the wheel holds
+        // the timers due within 64^(L+1) ticks, in the slot picked by bits
+        // 6L..6L+5 of their expiry; a level cascades into the one below each
+        // time the lower levels wrap. Kernel expirations are counted in
+        // signal context and the dispatcher thread advances the wheel to
+        // that count, so the wheel never runs ahead of the kernel timer.
+        class timer_engine
+        {
+        public:
+            timer_engine(int signum, std::chrono::nanoseconds tick);
+            timer_engine(const timer_engine &) = delete;
+            timer_engine &operator=(const timer_engine &) = delete;
+            ~timer_engine();
+
+            // called in signal context
+            void expired();
+
+            // called on the dispatcher thread
+            void advance();
+
+            sigfn::timer_id schedule(std::chrono::nanoseconds after, std::chrono::nanoseconds period, sigfn::timer_wheel::timer_function callback);
+            bool cancel(sigfn::timer_id id);
+            std::size_t size() const;
+            void close();
+
+        private:
+            static constexpr std::size_t level_bits = 6;
+            static constexpr std::size_t level_slots = std::size_t(1) << level_bits;
+            static constexpr std::size_t level_count = 4;
+
+            struct timer
+            {
+                std::uint64_t expiry;
+                std::uint64_t period;
+                std::shared_ptr<sigfn::timer_wheel::timer_function> callback;
+            };
+
+            struct firing
+            {
+                sigfn::timer_id id;
+                std::uint64_t overruns;
+                std::shared_ptr<sigfn::timer_wheel::timer_function> callback;
+            };
+
+            std::uint64_t ticks(std::chrono::nanoseconds duration) const;
+            void insert(sigfn::timer_id id, std::uint64_t expiry);
+            void cascade(std::size_t level);
+            void expire(std::uint64_t target, std::vector<firing> &fired);
+            void arm(bool armed);
+
+            mutable std::mutex _mutex;
+            std::array<std::array<std::vector<sigfn::timer_id>, level_slots>, level_count> _slots;
+            std::unordered_map<sigfn::timer_id, timer> _timers;
+            std::atomic<std::uint64_t> _ticks{0};
+            std::uint64_t _current{0};
+            sigfn::timer_id _serial{0};
+            bool _armed{false};
+            bool _created{false};
+#ifdef SIGFN_POSIX_TIMERS
+            timer_t _timer;
+#endif
+            const std::chrono::nanoseconds _tick;
+        };
+
+        struct interrupt_slot
+        {
+            std::atomic<bool> flag{false};
+            pthread_t thread;
+            sigfn::handler_function callback;
+        };
+
+        // Threads registered with a sigfn::thread_interrupter. The slot of
+        // the calling thread is also published in a thread_local table
+        // indexed by signal, which is all the signal handler reads.
+        class interrupt_registry
+        {
+        public:
+            explicit interrupt_registry(int signum) : _signum(signum)
+            {
+            }
+
+            interrupt_registry(const interrupt_registry &) = delete;
+            interrupt_registry &operator=(const interrupt_registry &) = delete;
+
+            // called in signal context, in the interrupted thread
+            static void deliver(int signum);
+
+            sigfn::thread_token enter(interrupt_slot *slot);
+            void leave(sigfn::thread_token token);
+            bool interrupt(sigfn::thread_token token);
+            std::size_t size() const;
+
+            int signum() const
+            {
+                return _signum;
+            }
+
+        private:
+            mutable std::mutex _mutex;
+            std::unordered_map<sigfn::thread_token, interrupt_slot *> _slots;
+            sigfn::thread_token _serial{0};
+            const int _signum;
+        };
+
+        // Reporter for fatal signals, installed with sigaction directly so it
+        // does not depend on the handler table of a process that may already
+        // be corrupt. Everything the handler touches is allocated at install
+        // time; the report is formatted on the stack and written with
+        // write(2), then the previous disposition runs or the signal is
+        // raised again with SIG_DFL.
+        class crash_reporter
+        {
+        public:
+            void install(int fd, const int *signums, std::size_t count);
+            void uninstall();
+
+            static void thread_init();
+
+            // called in signal context, on the alternate stack when there is one
+            static void report(int signum, siginfo_t *info, void *context);
+
+        private:
+            static constexpr int frame_capacity = 64;
+
+            void write_report(int fd, int signum, const siginfo_t *info, void *context);
+            void chain(int signum, const siginfo_t *info);
+
+            std::mutex _mutex;
+            std::array<struct sigaction, signal_count> _previous{};
+            std::array<std::atomic<bool>, signal_count> _installed{};
+            std::atomic<int> _fd{-1};
+            std::atomic<bool> _reporting{false};
+            std::atomic<bool> _reported{false};
+            void *_frames[frame_capacity];
+        };
+
+        // per-thread single producer rings of raw stacks, filled in signal
+        // context and drained into the aggregate under the mutex; the ring
+        // storage is allocated once and left untouched until a thread
+        // samples into it
+        class sample_profiler
+        {
+        public:
+            sample_profiler(unsigned int frequency, std::size_t threads, std::size_t capacity);
+            sample_profiler(const sample_profiler &) = delete;
+            sample_profiler &operator=(const sample_profiler &) = delete;
+
+            // called in signal context
+            void sample();
+
+            // called on the dispatcher thread and before dumps
+            void drain();
+
+            void start();
+            void stop();
+            bool running() const;
+            std::uint64_t samples() const;
+            std::uint64_t dropped() const;
+            bool dump(int fd);
+            void clear();
+
+        private:
+            static constexpr std::size_t frame_capacity = 64;
+
+            struct stack
+            {
+                int depth;
+                void *frames[frame_capacity];
+            };
+
+            struct ring
+            {
+                std::atomic<pid_t> owner{0};
+                alignas(64) std::atomic<std::uint64_t> head{0};
+                alignas(64) std::atomic<std::uint64_t> tail{0};
+                std::unique_ptr<stack[]> stacks;
+            };
+
+            static std::atomic<sample_profiler *> active;
+
+            ring *claim(pid_t tid);
+            std::vector<void *> trim(const stack &raw) const;
+
+            const std::chrono::microseconds _interval;
+            const std::size_t _threads;
+            const std::size_t _capacity;
+            const void *_module;
+            std::unique_ptr<ring[]> _rings;
+            std::atomic<bool> _running{false};
+            std::atomic<std::uint64_t> _samples{0};
+            std::atomic<std::uint64_t> _dropped{0};
+            std::mutex _mutex;
+            std::map<std::vector<void *>, std::uint64_t> _stacks;
+        };
+
+        // shared by suppress_sigpipe and the C scope functions; release
+        // returns true if a SIGPIPE raised in the scope was consumed
+        void sigpipe_block(bool &nested, bool &restore, bool &pending);
+        bool sigpipe_release(bool nested, bool restore, bool pending);
+#endif
 
         struct state
         {
-            static std::unordered_map<int, sigfn::handler_function> handler_map;
-            static std::string error_message;
-            static void hook(int signum, __sighandler_t callback);
+            static async_registry async_waiters;
+            static dispatch_table handler_table;
+            static dispatcher deferred_dispatcher;
+            static stats_table statistics;
+            static signal_bitmap watched;
+            static rate_limiter limits;
+#ifndef _WIN32
+            static trace_buffer tracer;
+            static crash_reporter crashes;
+#endif
+            static std::array<char, 128> error_message;
+            static void hook(int signum, __sighandler_t disposition);
+            static void attach(int signum, int flags);
+#ifdef _WIN32
             static void callback(int signum);
+#else
+            static void callback(int signum, siginfo_t *info, void *context);
+#endif
         };
 
         // adding because the C++ interface is not cooperating with the template
         void handle(int signum, sigfn_handler_func handler, void *userdata);
 
+        void defer(int signum, sigfn_handler_func handler, void *userdata);
+
+        void coalesce(int signum, sigfn_batch_func handler, void *userdata, const struct timeval *window, std::uint64_t threshold);
+
+#ifndef _WIN32
+        void handle_info(int signum, sigfn_info_handler_func handler, void *userdata, int flags);
+#endif
+
+        sigfn::handler_function make_handler(sigfn_handler_func handler, void *userdata);
+
+        template <class F, class... Args>
+        int try_catch_return(F &&f, Args &&...args)
+        {
+            int result(0);
+            try
+            {
+                f(std::forward<Args>(args)...);
+                state::error_message[0] = '\0';
+            }
+            catch (const std::exception &e)
+            {
+                std::strncpy(state::error_message.data(), e.what(), state::error_message.size() - 1);
+                state::error_message.back() = '\0';
+                result = -1;
+            }
+            return result;
+        }
+
+#ifdef SIGFN_SIGTIMEDWAIT
+        template <class IteratorType>
+        sigset_t make_sigset(IteratorType begin, IteratorType end)
+        {
+            sigset_t sigset;
+            if (begin == end)
+            {
+                throw error(empty_sigset);
+            }
+            sigemptyset(&sigset);
+            std::for_each(
+                begin,
+                end,
+                [&](int signum)
+                {
+                    if (sigaddset(&sigset, signum) != 0)
+                    {
+                        throw error(invalid_signum);
+                    }
+                });
+            return sigset;
+        }
+
+        // Blocks the set in the calling thread and consumes one signal with
+        // sigwaitinfo/sigtimedwait. The previous mask and any disposition that
+        // had to be replaced are restored before returning.
+        void wait_sigset(const sigset_t &sigset, int &signum);
+
+        bool wait_sigset(const sigset_t &sigset, int &signum, const std::chrono::steady_clock::time_point &deadline);
+
+        bool wait_sigset(const sigset_t &sigset, int &signum, const std::chrono::system_clock::time_point &deadline);
+
+        template <class IteratorType>
+        void wait(IteratorType begin, IteratorType end, int &signum)
+        {
+            wait_sigset(make_sigset(begin, end), signum);
+        }
+
+        template <class IteratorType>
+        bool wait_for(IteratorType begin, IteratorType end, int &signum, const std::chrono::system_clock::duration &timeout)
+        {
+            const sigset_t sigset = make_sigset(begin, end);
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            bool ready(false);
+            if (timeout >= std::chrono::steady_clock::time_point::max() - now)
+            {
+                wait_sigset(sigset, signum);
+                ready = true;
+            }
+            else
+            {
+                ready = wait_sigset(sigset, signum, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+            }
+            return ready;
+        }
+
+        template <class IteratorType>
+        bool wait_until(IteratorType begin, IteratorType end, int &signum, const std::chrono::system_clock::time_point &deadline)
+        {
+            return wait_sigset(make_sigset(begin, end), signum, deadline);
+        }
+#else
         template <class IteratorType>
         void handle_sigset(IteratorType begin, IteratorType end, std::promise<int> &promise)
         {
@@ -73,25 +1290,8 @@ namespace sigfn
             }
             else
             {
-                throw std::runtime_error(empty_sigset);
-            }
-        }
-
-        template <class F, class... Args>
-        int try_catch_return(F &&f, Args &&...args)
-        {
-            int result(0);
-            try
-            {
-                f(std::forward<Args>(args)...);
-                state::error_message.clear();
-            }
-            catch (const std::exception &e)
-            {
-                state::error_message = e.what();
-                result = -1;
+                throw error(empty_sigset);
             }
-            return result;
         }
 
         template <class IteratorType>
@@ -131,10 +1331,15 @@ namespace sigfn
             }
             return ready;
         }
+#endif
 
         std::chrono::system_clock::duration make_duration(const struct timeval *timeval);
 
         std::chrono::system_clock::time_point make_time_point(const struct timeval *timeval);
+
+#ifndef _WIN32
+        sigfn::trace_format make_trace_format(int format);
+#endif
     }
 }
 
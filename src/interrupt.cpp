@@ -0,0 +1,147 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+namespace
+{
+    // slot of the calling thread per interrupter signal; plain pointers, so
+    // the table is zero-initialized and safe to read in signal context once
+    // the thread has touched it
+    thread_local sigfn::internal::interrupt_slot *current[sigfn::internal::signal_count];
+}
+
+void sigfn::internal::interrupt_registry::deliver(int signum)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        interrupt_slot *const slot = current[signum];
+        if (slot != nullptr && slot->callback)
+        {
+            slot->callback(signum);
+        }
+    }
+}
+
+sigfn::thread_token sigfn::internal::interrupt_registry::enter(interrupt_slot *slot)
+{
+    if (current[_signum] != nullptr)
+    {
+        throw error(thread_registered);
+    }
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const sigfn::thread_token token = ++_serial;
+    _slots.emplace(token, slot);
+    current[_signum] = slot;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    return token;
+}
+
+void sigfn::internal::interrupt_registry::leave(sigfn::thread_token token)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _slots.erase(token);
+    // a signal still on its way finds no slot and only interrupts the call
+    current[_signum] = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+bool sigfn::internal::interrupt_registry::interrupt(sigfn::thread_token token)
+{
+    // the lock keeps the thread registered, and so alive, until it is signalled
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const std::unordered_map<sigfn::thread_token, interrupt_slot *>::iterator found = _slots.find(token);
+    const bool registered = (found != _slots.end());
+    if (registered)
+    {
+        found->second->flag.store(true, std::memory_order_release);
+        if (pthread_kill(found->second->thread, _signum) != 0)
+        {
+            throw error(invalid_syscall);
+        }
+    }
+    return registered;
+}
+
+std::size_t sigfn::internal::interrupt_registry::size() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _slots.size();
+}
+
+sigfn::thread_interrupter::thread_interrupter(int signum)
+{
+    if (signum < SIGRTMIN || signum > SIGRTMAX)
+    {
+        throw internal::error(internal::invalid_realtime);
+    }
+    _registry = std::make_shared<internal::interrupt_registry>(signum);
+    // without SA_RESTART, so the blocked call returns EINTR instead of resuming
+    _token = internal::state::handler_table.claim(
+        signum,
+        new internal::handler_entry(sigfn::info_handler_function(
+            [](const signal_info &info)
+            {
+                internal::interrupt_registry::deliver(info.signum());
+            })),
+        0);
+}
+
+sigfn::thread_interrupter::~thread_interrupter()
+{
+    internal::state::handler_table.unclaim(_token);
+}
+
+bool sigfn::thread_interrupter::interrupt(thread_token token)
+{
+    return _registry->interrupt(token);
+}
+
+std::size_t sigfn::thread_interrupter::size() const
+{
+    return _registry->size();
+}
+
+sigfn::interrupt_scope::interrupt_scope(thread_interrupter &interrupter, handler_function callback)
+    : _registry(interrupter._registry), _slot(std::make_shared<internal::interrupt_slot>())
+{
+    _slot->thread = pthread_self();
+    _slot->callback = std::move(callback);
+    _flag = &_slot->flag;
+    _token = _registry->enter(_slot.get());
+}
+
+sigfn::interrupt_scope::~interrupt_scope()
+{
+    _registry->leave(_token);
+}
+
+sigfn::thread_token sigfn::interrupt_scope::token() const
+{
+    return _token;
+}
+
+bool sigfn::interrupt_scope::reset()
+{
+    return _slot->flag.exchange(false, std::memory_order_acq_rel);
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+void sigfn::internal::rate_limiter::token_bucket(int signum, std::uint64_t interval_ns, std::uint64_t burst)
+{
+    configure(signum, bucket, interval_ns, burst);
+}
+
+void sigfn::internal::rate_limiter::throttle(int signum, std::uint64_t interval_ns)
+{
+    configure(signum, throttled, interval_ns, 1);
+}
+
+void sigfn::internal::rate_limiter::debounce(int signum, std::uint64_t interval_ns)
+{
+    configure(signum, debounced, interval_ns, 1);
+}
+
+void sigfn::internal::rate_limiter::clear(int signum)
+{
+    configure(signum, none, 0, 0);
+}
+
+void sigfn::internal::rate_limiter::configure(int signum, int policy, std::uint64_t interval_ns, std::uint64_t burst)
+{
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_signum);
+    }
+    if (policy != none && (interval_ns == 0 || burst == 0))
+    {
+        throw error(invalid_rate);
+    }
+    // deliveries pass while the parameters change, so they never see a mix
+    limit &limit = _limits[signum];
+    limit.policy.store(none);
+    limit.interval_ns.store(interval_ns);
+    limit.burst.store(burst);
+    limit.stamp.store(0);
+    limit.policy.store(policy);
+}
+
+sigfn::internal::rate_limiter::verdict sigfn::internal::rate_limiter::admit(int signum)
+{
+    verdict result(verdict::admitted);
+    limit &limit = _limits[signum];
+    const int policy = limit.policy.load(std::memory_order_acquire);
+    if (policy != none)
+    {
+        const std::uint64_t now = monotonic_ns();
+        const std::uint64_t interval = limit.interval_ns.load(std::memory_order_relaxed);
+        std::uint64_t stamp = limit.stamp.load(std::memory_order_relaxed);
+        if (policy == bucket)
+        {
+            // stamp is the theoretical arrival time; a burst may run that far ahead of now
+            // saturated, so a long interval with a large burst does not wrap
+            const std::uint64_t extra = limit.burst.load(std::memory_order_relaxed) - 1;
+            const std::uint64_t tolerance = (extra > UINT64_MAX / interval) ? UINT64_MAX : extra * interval;
+            result = verdict::suppressed;
+            for (;;)
+            {
+                const std::uint64_t base = std::max(stamp, now);
+                if (base - now > tolerance)
+                {
+                    break;
+                }
+                if (limit.stamp.compare_exchange_weak(stamp, base + interval, std::memory_order_relaxed))
+                {
+                    result = verdict::admitted;
+                    break;
+                }
+            }
+        }
+        else if (policy == throttled)
+        {
+            // stamp is the earliest time the next delivery may pass
+            result = verdict::suppressed;
+            while (now >= stamp)
+            {
+                if (limit.stamp.compare_exchange_weak(stamp, now + interval, std::memory_order_relaxed))
+                {
+                    result = verdict::admitted;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            // stamp is the time of the last delivery
+            limit.stamp.store(now, std::memory_order_relaxed);
+            result = limit.held.exchange(true, std::memory_order_acq_rel) ? verdict::folded : verdict::held;
+        }
+    }
+    return result;
+}
+
+bool sigfn::internal::rate_limiter::release(int signum, std::optional<std::chrono::nanoseconds> &remaining)
+{
+    bool due(false);
+    limit &limit = _limits[signum];
+    if (limit.held.load(std::memory_order_acquire))
+    {
+        const std::uint64_t now = monotonic_ns();
+        const std::uint64_t last = limit.stamp.load(std::memory_order_relaxed);
+        const std::uint64_t interval = limit.interval_ns.load(std::memory_order_relaxed);
+        if (now - std::min(last, now) >= interval)
+        {
+            // a delivery after the exchange holds a new edge and wakes the dispatcher again
+            due = limit.held.exchange(false, std::memory_order_acq_rel);
+        }
+        else
+        {
+            remaining = std::chrono::nanoseconds(interval - (now - last));
+        }
+    }
+    return due;
+}
+
+void sigfn::rate_limit(int signum, double rate, std::uint64_t burst)
+{
+    if (!(rate > 0.0) || rate > 1e9)
+    {
+        throw internal::error(internal::invalid_rate);
+    }
+    // like a throttle interval, the interval must fit in nanoseconds, so the
+    // conversion stays defined for tiny rates
+    const double interval_ns = 1e9 / rate;
+    if (!(interval_ns < static_cast<double>(std::chrono::nanoseconds::max().count())))
+    {
+        throw internal::error(internal::invalid_rate);
+    }
+    internal::state::limits.token_bucket(signum, static_cast<std::uint64_t>(interval_ns), burst);
+}
+
+void sigfn::throttle(int signum, const std::chrono::steady_clock::duration &interval)
+{
+    internal::state::limits.throttle(signum, static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count(), 0)));
+}
+
+void sigfn::debounce(int signum, const std::chrono::steady_clock::duration &interval)
+{
+    // the trailing edge is released by the dispatcher thread
+    internal::state::deferred_dispatcher.start();
+    internal::state::limits.debounce(signum, static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count(), 0)));
+}
+
+void sigfn::unlimit(int signum)
+{
+    internal::state::limits.clear(signum);
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <sys/time.h>
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define SIGFN_BACKTRACE
+#endif
+#endif
+
+namespace
+{
+    std::size_t power_of_two(std::size_t capacity)
+    {
+        std::size_t size(1);
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // base address of the object containing an address, nullptr if unknown
+    const void *module_of(const void *address)
+    {
+        Dl_info info;
+        return (dladdr(address, &info) != 0) ? info.dli_fbase : nullptr;
+    }
+
+    // demangled symbol, module offset or raw address of a frame
+    std::string symbolize(const void *address)
+    {
+        std::string name;
+        Dl_info info;
+        if (dladdr(address, &info) != 0 && info.dli_sname != nullptr)
+        {
+            int status(0);
+            char *const demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+            std::free(demangled);
+        }
+        else
+        {
+            char offset[2 + 2 * sizeof(std::uintptr_t) + 1];
+            const bool found = (dladdr(address, &info) != 0 && info.dli_fname != nullptr);
+            const std::uintptr_t value = reinterpret_cast<std::uintptr_t>(address) - (found ? reinterpret_cast<std::uintptr_t>(info.dli_fbase) : 0);
+            std::snprintf(offset, sizeof(offset), "0x%jx", static_cast<std::uintmax_t>(value));
+            if (found)
+            {
+                const char *const separator = std::strrchr(info.dli_fname, '/');
+                name = separator != nullptr ? separator + 1 : info.dli_fname;
+                name += '+';
+            }
+            name += offset;
+        }
+        // semicolons separate frames in the folded format
+        for (char &character : name)
+        {
+            if (character == ';')
+            {
+                character = ':';
+            }
+        }
+        return name;
+    }
+}
+
+std::atomic<sigfn::internal::sample_profiler *> sigfn::internal::sample_profiler::active{nullptr};
+
+sigfn::internal::sample_profiler::sample_profiler(unsigned int frequency, std::size_t threads, std::size_t capacity)
+    : _interval(frequency == 0 ? 0 : 1000000 / frequency), _threads(threads), _capacity(power_of_two(capacity)),
+      _module(module_of(reinterpret_cast<const void *>(&module_of)))
+{
+#ifdef SIGFN_BACKTRACE
+    if (_interval.count() == 0 || threads == 0 || capacity == 0)
+    {
+        throw error(invalid_profiler);
+    }
+    // the first call may load the unwinder, which is not safe in a handler
+    void *frame(nullptr);
+    static_cast<void>(backtrace(&frame, 1));
+    _rings.reset(new ring[_threads]);
+    for (std::size_t index = 0; index < _threads; index++)
+    {
+        // left uninitialized, pages are only committed once a thread samples
+        _rings[index].stacks.reset(new stack[_capacity]);
+    }
+#else
+    throw error(unsupported);
+#endif
+}
+
+sigfn::internal::sample_profiler::ring *sigfn::internal::sample_profiler::claim(pid_t tid)
+{
+    ring *claimed(nullptr);
+    for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+    {
+        if (_rings[index].owner.load(std::memory_order_relaxed) == tid)
+        {
+            claimed = &_rings[index];
+        }
+    }
+    for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+    {
+        pid_t expected(0);
+        if (_rings[index].owner.compare_exchange_strong(expected, tid) || expected == tid)
+        {
+            claimed = &_rings[index];
+        }
+    }
+    // once every ring is owned, take over one whose thread exited; samples
+    // it still holds are drained by the next aggregation as usual
+    for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+    {
+        pid_t owner = _rings[index].owner.load(std::memory_order_relaxed);
+        if (owner != tid && thread_exited(owner) && _rings[index].owner.compare_exchange_strong(owner, tid))
+        {
+            claimed = &_rings[index];
+        }
+    }
+    return claimed;
+}
+
+void sigfn::internal::sample_profiler::sample()
+{
+#ifdef SIGFN_BACKTRACE
+    if (!_running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    ring *const target = claim(thread_id());
+    if (target == nullptr)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // only this thread produces into the ring, and SIGPROF is blocked while
+    // its handler runs, so the head cannot move under us
+    const std::uint64_t head = target->head.load(std::memory_order_relaxed);
+    if (head - target->tail.load(std::memory_order_acquire) >= _capacity)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    stack &slot = target->stacks[head & (_capacity - 1)];
+    slot.depth = backtrace(slot.frames, static_cast<int>(frame_capacity));
+    target->head.store(head + 1, std::memory_order_release);
+    _samples.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+std::vector<void *> sigfn::internal::sample_profiler::trim(const stack &raw) const
+{
+    // the innermost frames are this library's handler path, followed by the
+    // signal trampoline; the sampled code starts after the trampoline
+    int first(0);
+    while (first < raw.depth && module_of(raw.frames[first]) == _module)
+    {
+        first++;
+    }
+    first = (first < raw.depth) ? first + 1 : 0;
+    return std::vector<void *>(raw.frames + first, raw.frames + raw.depth);
+}
+
+void sigfn::internal::sample_profiler::drain()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t index = 0; index < _threads; index++)
+    {
+        ring &source = _rings[index];
+        if (source.owner.load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+        const std::uint64_t head = source.head.load(std::memory_order_acquire);
+        std::uint64_t tail = source.tail.load(std::memory_order_relaxed);
+        for (; tail < head; tail++)
+        {
+            const std::vector<void *> frames = trim(source.stacks[tail & (_capacity - 1)]);
+            if (!frames.empty())
+            {
+                _stacks[frames]++;
+            }
+        }
+        source.tail.store(tail, std::memory_order_release);
+    }
+}
+
+void sigfn::internal::sample_profiler::start()
+{
+    sample_profiler *expected(nullptr);
+    if (!active.compare_exchange_strong(expected, this) && expected != this)
+    {
+        throw error(profiler_running);
+    }
+    if (expected == nullptr)
+    {
+        struct itimerval timer = {};
+        timer.it_interval.tv_sec = static_cast<time_t>(_interval.count() / 1000000);
+        timer.it_interval.tv_usec = static_cast<suseconds_t>(_interval.count() % 1000000);
+        timer.it_value = timer.it_interval;
+        _running.store(true, std::memory_order_release);
+        if (setitimer(ITIMER_PROF, &timer, nullptr) == -1)
+        {
+            _running.store(false, std::memory_order_release);
+            active.store(nullptr);
+            throw error(invalid_syscall);
+        }
+    }
+}
+
+void sigfn::internal::sample_profiler::stop()
+{
+    sample_profiler *expected(this);
+    if (active.compare_exchange_strong(expected, nullptr))
+    {
+        const struct itimerval timer = {};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        _running.store(false, std::memory_order_release);
+    }
+    drain();
+}
+
+bool sigfn::internal::sample_profiler::running() const
+{
+    return _running.load(std::memory_order_acquire);
+}
+
+std::uint64_t sigfn::internal::sample_profiler::samples() const
+{
+    return _samples.load(std::memory_order_relaxed);
+}
+
+std::uint64_t sigfn::internal::sample_profiler::dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+bool sigfn::internal::sample_profiler::dump(int fd)
+{
+    drain();
+    std::unordered_map<const void *, std::string> symbols;
+    std::map<std::string, std::uint64_t> folded;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        for (const std::pair<const std::vector<void *>, std::uint64_t> &entry : _stacks)
+        {
+            // outermost frame first; return addresses are moved back into
+            // the call instruction, only the sampled frame is exact, and
+            // stacks that differ only in offsets are merged by name
+            std::string line;
+            for (std::size_t index = entry.first.size(); index > 0; index--)
+            {
+                const char *const address = static_cast<const char *>(entry.first[index - 1]) - (index > 1 ? 1 : 0);
+                std::unordered_map<const void *, std::string>::iterator found = symbols.find(address);
+                if (found == symbols.end())
+                {
+                    found = symbols.emplace(address, symbolize(address)).first;
+                }
+                line += found->second;
+                line += (index > 1) ? ";" : "";
+            }
+            folded[line] += entry.second;
+        }
+    }
+    fd_writer out(fd);
+    for (const std::pair<const std::string, std::uint64_t> &entry : folded)
+    {
+        out.text(entry.first.c_str());
+        out.text(" ");
+        out.number(entry.second);
+        out.text("\n");
+    }
+    return out.flush();
+}
+
+void sigfn::internal::sample_profiler::clear()
+{
+    drain();
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _stacks.clear();
+    _samples.store(0, std::memory_order_relaxed);
+    _dropped.store(0, std::memory_order_relaxed);
+}
+
+sigfn::profiler::profiler(unsigned int frequency, std::size_t threads, std::size_t capacity)
+    : _profiler(std::make_shared<internal::sample_profiler>(frequency, threads, capacity)), _claim(0), _token(0)
+{
+}
+
+sigfn::profiler::~profiler()
+{
+    stop();
+}
+
+void sigfn::profiler::start()
+{
+    if (_claim != 0)
+    {
+        _profiler->start();
+        return;
+    }
+    // SIGPROF is claimed only while sampling, and claimed rather than
+    // attached, so stop can keep a handler for a SIGPROF still pending
+    const std::shared_ptr<internal::sample_profiler> profiler = _profiler;
+    _claim = internal::state::handler_table.claim(
+        SIGPROF,
+        new internal::handler_entry(sigfn::handler_function(
+            [profiler](int)
+            {
+                profiler->sample();
+            })),
+        sigfn::restart);
+    try
+    {
+        _token = sigfn::attach_deferred(
+            SIGPROF,
+            [profiler](int)
+            {
+                profiler->drain();
+            });
+        try
+        {
+            _profiler->start();
+        }
+        catch (...)
+        {
+            sigfn::detach(_token);
+            throw;
+        }
+    }
+    catch (...)
+    {
+        internal::state::handler_table.unclaim(_claim);
+        _claim = 0;
+        throw;
+    }
+}
+
+void sigfn::profiler::stop()
+{
+    // A SIGPROF generated just before the timer is disarmed can still be
+    // pending. The claim holds the slot while the deferred link goes, and
+    // unclaim then leaves the previous handler, or an empty sigfn handler
+    // when SIGPROF was at its default action, never the default itself.
+    _profiler->stop();
+    if (_claim != 0)
+    {
+        sigfn::detach(_token);
+        internal::state::handler_table.unclaim(_claim);
+        _claim = 0;
+    }
+}
+
+bool sigfn::profiler::running() const
+{
+    return _profiler->running();
+}
+
+std::uint64_t sigfn::profiler::samples() const
+{
+    return _profiler->samples();
+}
+
+std::uint64_t sigfn::profiler::dropped() const
+{
+    return _profiler->dropped();
+}
+
+void sigfn::profiler::dump(int fd)
+{
+    if (!_profiler->dump(fd))
+    {
+        throw internal::error(internal::invalid_profile);
+    }
+}
+
+void sigfn::profiler::clear()
+{
+    _profiler->clear();
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#ifndef _WIN32
+void sigfn::internal::realtime_ring::push(const siginfo_t &info)
+{
+    const sigfn::queued_signal signal = {info.si_signo, info.si_code, info.si_pid, info.si_uid, info.si_value};
+    if (!_queue.push(signal))
+    {
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+        state::statistics.dropped(info.si_signo);
+    }
+}
+
+sigfn::realtime_queue::realtime_queue(std::initializer_list<int> signums, std::size_t capacity) : realtime_queue(signums.begin(), signums.size(), capacity)
+{
+}
+
+sigfn::realtime_queue::realtime_queue(const int *signums, std::size_t count, std::size_t capacity)
+{
+    if (signums == nullptr || count == 0)
+    {
+        throw internal::error(internal::empty_sigset);
+    }
+    if (capacity == 0)
+    {
+        throw internal::error(internal::invalid_capacity);
+    }
+    for (std::size_t index = 0; index < count; index++)
+    {
+        if (signums[index] < SIGRTMIN || signums[index] > SIGRTMAX)
+        {
+            throw internal::error(internal::invalid_realtime);
+        }
+    }
+    _ring = std::make_shared<internal::realtime_ring>(capacity);
+    _tokens.reserve(count);
+    try
+    {
+        for (std::size_t index = 0; index < count; index++)
+        {
+            // each handler owns a reference, so the ring outlives any delivery
+            // still running when the queue is destroyed
+            _tokens.push_back(internal::state::handler_table.claim(
+                signums[index],
+                new internal::handler_entry(sigfn::info_handler_function(
+                    [ring = _ring](const sigfn::signal_info &info)
+                    {
+                        ring->push(info.native());
+                    })),
+                sigfn::restart));
+        }
+    }
+    catch (...)
+    {
+        for (const handler_token token : _tokens)
+        {
+            internal::state::handler_table.unclaim(token);
+        }
+        throw;
+    }
+}
+
+sigfn::realtime_queue::~realtime_queue()
+{
+    for (const handler_token token : _tokens)
+    {
+        internal::state::handler_table.unclaim(token);
+    }
+}
+
+std::size_t sigfn::realtime_queue::drain(queued_signal *signals, std::size_t max)
+{
+    std::size_t drained(0);
+    if (signals != nullptr)
+    {
+        while (drained < max && _ring->pop(signals[drained]))
+        {
+            drained++;
+        }
+    }
+    return drained;
+}
+
+std::uint64_t sigfn::realtime_queue::overflows() const
+{
+    return _ring->overflows();
+}
+#endif
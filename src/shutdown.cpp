@@ -0,0 +1,275 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#include <cstdlib>
+
+namespace
+{
+    // Completion of the components of one stage. Shared with the drain
+    // threads, so a thread abandoned at its deadline never outlives it.
+    struct stage_progress
+    {
+        explicit stage_progress(std::size_t size) : finished(size, false), failed(size, false), elapsed(size)
+        {
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<bool> finished;
+        std::vector<bool> failed;
+        std::vector<std::chrono::nanoseconds> elapsed;
+    };
+}
+
+void sigfn::internal::shutdown_state::signalled()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _signalled.notify_all();
+    }
+    if (deliveries.load() > 1)
+    {
+        escalate();
+    }
+}
+
+void sigfn::internal::shutdown_state::add(component added)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _components.push_back(std::move(added));
+}
+
+void sigfn::internal::shutdown_state::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _signalled.wait(
+        lock,
+        [&]()
+        {
+            return deliveries.load() > 0;
+        });
+}
+
+std::vector<sigfn::shutdown_timing> sigfn::internal::shutdown_state::run()
+{
+    std::lock_guard<std::mutex> run_lock(_run_mutex);
+    if (!_report.has_value())
+    {
+        std::vector<component> components;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            components = _components;
+        }
+        std::stable_sort(
+            components.begin(),
+            components.end(),
+            [](const component &left, const component &right)
+            {
+                return left.stage < right.stage;
+            });
+        std::vector<sigfn::shutdown_timing> report;
+        report.reserve(components.size());
+        std::size_t first(0);
+        while (first < components.size())
+        {
+            std::size_t last(first);
+            while (last < components.size() && components[last].stage == components[first].stage)
+            {
+                last++;
+            }
+            if (_escalated.load())
+            {
+                for (std::size_t index = first; index < last; index++)
+                {
+                    report.push_back({components[index].name, components[index].stage, sigfn::shutdown_status::skipped, std::chrono::nanoseconds::zero()});
+                }
+            }
+            else
+            {
+                const std::shared_ptr<stage_progress> progress = std::make_shared<stage_progress>(last - first);
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (std::size_t index = first; index < last; index++)
+                {
+                    std::thread(
+                        [progress, slot = index - first, drain = components[index].drain, start]()
+                        {
+                            bool failed(false);
+                            try
+                            {
+                                drain();
+                            }
+                            catch (...)
+                            {
+                                failed = true;
+                            }
+                            const std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                            std::lock_guard<std::mutex> lock(progress->mutex);
+                            progress->finished[slot] = true;
+                            progress->failed[slot] = failed;
+                            progress->elapsed[slot] = elapsed;
+                            progress->changed.notify_all();
+                        })
+                        .detach();
+                }
+                // wait for the earliest deadline of the drains still running
+                bool timed_out(false);
+                std::unique_lock<std::mutex> lock(progress->mutex);
+                while (!timed_out)
+                {
+                    std::optional<std::size_t> next;
+                    for (std::size_t index = first; index < last; index++)
+                    {
+                        if (!progress->finished[index - first] && (!next.has_value() || components[index].timeout < components[next.value()].timeout))
+                        {
+                            next = index;
+                        }
+                    }
+                    if (!next.has_value())
+                    {
+                        break;
+                    }
+                    const std::size_t slot = next.value() - first;
+                    timed_out = !progress->changed.wait_until(
+                        lock,
+                        start + components[next.value()].timeout,
+                        [&]()
+                        {
+                            return progress->finished[slot];
+                        });
+                }
+                const std::chrono::nanoseconds now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                for (std::size_t index = first; index < last; index++)
+                {
+                    const std::size_t slot = index - first;
+                    if (!progress->finished[slot])
+                    {
+                        report.push_back({components[index].name, components[index].stage, sigfn::shutdown_status::timed_out, now});
+                    }
+                    else
+                    {
+                        report.push_back({components[index].name, components[index].stage, progress->failed[slot] ? sigfn::shutdown_status::failed : sigfn::shutdown_status::completed, progress->elapsed[slot]});
+                    }
+                }
+                lock.unlock();
+                if (timed_out)
+                {
+                    escalate();
+                }
+            }
+            first = last;
+        }
+        _report = std::move(report);
+    }
+    return _report.value();
+}
+
+void sigfn::internal::shutdown_state::escalate()
+{
+    if (!_escalated.exchange(true))
+    {
+        if (_escalate)
+        {
+            _escalate();
+        }
+        else
+        {
+            std::_Exit(EXIT_FAILURE);
+        }
+    }
+}
+
+sigfn::shutdown_orchestrator::shutdown_orchestrator(std::initializer_list<int> signums, escalate_function escalate)
+    : shutdown_orchestrator(signums.begin(), signums.size(), std::move(escalate))
+{
+}
+
+sigfn::shutdown_orchestrator::shutdown_orchestrator(const int *signums, std::size_t count, escalate_function escalate)
+{
+    if (signums == nullptr || count == 0)
+    {
+        throw internal::error(internal::empty_sigset);
+    }
+    _state = std::make_shared<internal::shutdown_state>(std::move(escalate));
+    const std::shared_ptr<internal::shutdown_state> state = _state;
+    try
+    {
+        for (std::size_t index = 0; index < count; index++)
+        {
+            // counted in signal context, so two quick signals are never coalesced into one
+            _tokens.push_back(sigfn::attach(
+                signums[index],
+                [state](int)
+                {
+                    state->delivered();
+                }));
+            _tokens.push_back(sigfn::attach_deferred(
+                signums[index],
+                [state](int)
+                {
+                    state->signalled();
+                }));
+        }
+    }
+    catch (...)
+    {
+        for (const handler_token token : _tokens)
+        {
+            sigfn::detach(token);
+        }
+        throw;
+    }
+}
+
+sigfn::shutdown_orchestrator::~shutdown_orchestrator()
+{
+    for (const handler_token token : _tokens)
+    {
+        sigfn::detach(token);
+    }
+}
+
+void sigfn::shutdown_orchestrator::add(const std::string &name, int stage, const std::chrono::steady_clock::duration &timeout, std::function<void()> drain)
+{
+    if (!drain)
+    {
+        throw internal::error(internal::invalid_handler);
+    }
+    _state->add({name, stage, timeout, std::move(drain)});
+}
+
+bool sigfn::shutdown_orchestrator::requested() const
+{
+    return _state->deliveries.load() > 0;
+}
+
+std::vector<sigfn::shutdown_timing> sigfn::shutdown_orchestrator::wait()
+{
+    _state->wait();
+    return _state->run();
+}
+
+std::vector<sigfn::shutdown_timing> sigfn::shutdown_orchestrator::run()
+{
+    return _state->run();
+}
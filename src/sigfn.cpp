@@ -22,24 +22,122 @@
 
 #include "internal.hpp"
 
-std::unordered_map<int, sigfn::handler_function> sigfn::internal::state::handler_map;
-std::string sigfn::internal::state::error_message;
+#include <cerrno>
 
-void sigfn::internal::state::hook(int signum, __sighandler_t callback)
+// declared first so it outlives the dispatcher thread that completes its waiters
+sigfn::internal::async_registry sigfn::internal::state::async_waiters;
+sigfn::internal::dispatch_table sigfn::internal::state::handler_table;
+// declared after the table so the dispatcher thread is joined before the table is destroyed
+sigfn::internal::dispatcher sigfn::internal::state::deferred_dispatcher;
+sigfn::internal::stats_table sigfn::internal::state::statistics;
+sigfn::internal::signal_bitmap sigfn::internal::state::watched;
+sigfn::internal::rate_limiter sigfn::internal::state::limits;
+#ifndef _WIN32
+sigfn::internal::trace_buffer sigfn::internal::state::tracer;
+sigfn::internal::crash_reporter sigfn::internal::state::crashes;
+#endif
+std::array<char, 128> sigfn::internal::state::error_message{};
+
+void sigfn::internal::state::hook(int signum, __sighandler_t disposition)
 {
-    const __sighandler_t result = signal(signum, callback);
+#ifdef _WIN32
+    const __sighandler_t result = signal(signum, disposition);
     if (result == SIG_ERR)
     {
-        throw std::runtime_error(invalid_syscall);
+        throw error(invalid_syscall);
+    }
+#else
+    struct sigaction action = {};
+    action.sa_handler = disposition;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, nullptr) != 0)
+    {
+        throw error(invalid_syscall);
+    }
+#endif
+}
+
+void sigfn::internal::state::attach(int signum, int flags)
+{
+#ifdef _WIN32
+    static_cast<void>(flags);
+    hook(signum, callback);
+#else
+    struct sigaction action = {};
+    action.sa_sigaction = callback;
+    action.sa_flags = SA_SIGINFO;
+    action.sa_flags |= ((flags & sigfn::restart) != 0) ? SA_RESTART : 0;
+    action.sa_flags |= ((flags & sigfn::onstack) != 0) ? SA_ONSTACK : 0;
+    action.sa_flags |= ((flags & sigfn::nodefer) != 0) ? SA_NODEFER : 0;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, nullptr) != 0)
+    {
+        throw error(invalid_syscall);
     }
+#endif
 }
 
+#ifdef _WIN32
 void sigfn::internal::state::callback(int signum)
 {
-    handler_map.at(signum)(signum);
+    statistics.delivered(signum);
+    handler_table.deliver(signum, nullptr);
 }
+#else
+void sigfn::internal::state::callback(int signum, siginfo_t *info, void *context)
+{
+    static_cast<void>(context);
+    // the deferred path may write to the wakeup descriptor
+    const int saved_errno = errno;
+    statistics.delivered(signum);
+    handler_table.deliver(signum, info);
+    errno = saved_errno;
+}
+#endif
 
 void sigfn::internal::handle(int signum, sigfn_handler_func handler, void *userdata)
+{
+    sigfn::handle(signum, make_handler(handler, userdata));
+}
+
+void sigfn::internal::defer(int signum, sigfn_handler_func handler, void *userdata)
+{
+    sigfn::defer(signum, make_handler(handler, userdata));
+}
+
+void sigfn::internal::coalesce(int signum, sigfn_batch_func handler, void *userdata, const struct timeval *window, std::uint64_t threshold)
+{
+    sigfn::batch_function batch_function;
+    if (handler != nullptr)
+    {
+        batch_function = [handler, userdata](int signum, std::uint64_t count)
+        {
+            handler(signum, count, userdata);
+        };
+    }
+    sigfn::coalesce(
+        signum,
+        std::move(batch_function),
+        (window != nullptr) ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(make_duration(window)) : std::chrono::steady_clock::duration::zero(),
+        threshold);
+}
+
+#ifndef _WIN32
+void sigfn::internal::handle_info(int signum, sigfn_info_handler_func handler, void *userdata, int flags)
+{
+    sigfn::info_handler_function info_handler_function;
+    if (handler != nullptr)
+    {
+        info_handler_function = [handler, userdata](const sigfn::signal_info &info)
+        {
+            handler(&info.native(), userdata);
+        };
+    }
+    sigfn::handle_info(signum, std::move(info_handler_function), flags);
+}
+#endif
+
+sigfn::handler_function sigfn::internal::make_handler(sigfn_handler_func handler, void *userdata)
 {
     sigfn::handler_function handler_function;
     if (handler != nullptr)
@@ -49,14 +147,14 @@ void sigfn::internal::handle(int signum, sigfn_handler_func handler, void *userd
             handler(signum, userdata);
         };
     }
-    sigfn::handle(signum, handler_function);
+    return handler_function;
 }
 
 std::chrono::system_clock::duration sigfn::internal::make_duration(const struct timeval *timeval)
 {
     if (timeval == nullptr)
     {
-        throw std::runtime_error(invalid_timeval);
+        throw error(invalid_timeval);
     }
     return std::chrono::seconds(timeval->tv_sec) + std::chrono::microseconds(timeval->tv_usec);
 }
@@ -66,36 +164,205 @@ std::chrono::system_clock::time_point sigfn::internal::make_time_point(const str
     return std::chrono::system_clock::time_point(make_duration(timeval));
 }
 
+#ifndef _WIN32
+sigfn::trace_format sigfn::internal::make_trace_format(int format)
+{
+    if (format != SIGFN_TRACE_BINARY && format != SIGFN_TRACE_CHROME)
+    {
+        throw error(invalid_format);
+    }
+    return static_cast<sigfn::trace_format>(format);
+}
+#endif
+
+void sigfn::internal::attach_static(int signum, void (*trampoline)(int))
+{
+#ifdef _WIN32
+    const __sighandler_t result = signal(signum, trampoline);
+    if (result == SIG_ERR)
+    {
+        throw error(invalid_syscall);
+    }
+#else
+    struct sigaction action = {};
+    action.sa_handler = trampoline;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, nullptr) != 0)
+    {
+        throw error(invalid_syscall);
+    }
+#endif
+    // the kernel no longer reaches the table for this signal
+    state::handler_table.clear(signum);
+}
+
 void sigfn::handle(int signum, const sigfn::handler_function &handler)
 {
     if (!handler)
     {
-        throw std::runtime_error(sigfn::internal::invalid_handler);
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
     }
-    internal::state::hook(signum, internal::state::callback);
-    internal::state::handler_map[signum] = handler;
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(handler));
 }
 
 void sigfn::handle(int signum, sigfn::handler_function &&handler)
 {
     if (!handler)
     {
-        throw std::runtime_error(sigfn::internal::invalid_handler);
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(std::move(handler)));
+}
+
+#ifndef _WIN32
+void sigfn::handle_info(int signum, const sigfn::info_handler_function &handler, int flags)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::attach(signum, flags);
+    internal::state::handler_table.store(signum, new internal::handler_entry(handler));
+}
+
+void sigfn::handle_info(int signum, sigfn::info_handler_function &&handler, int flags)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::attach(signum, flags);
+    internal::state::handler_table.store(signum, new internal::handler_entry(std::move(handler)));
+}
+#endif
+
+void sigfn::defer(int signum, const sigfn::handler_function &handler)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::deferred_dispatcher.start();
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(handler, internal::dispatch_mode::deferred));
+}
+
+void sigfn::defer(int signum, sigfn::handler_function &&handler)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::deferred_dispatcher.start();
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(std::move(handler), internal::dispatch_mode::deferred));
+}
+
+void sigfn::defer(int signum, const sigfn::handler_function &handler, sigfn::thread_pool &pool, sigfn::priority level)
+{
+    sigfn::defer(signum, sigfn::handler_function(handler), pool, level);
+}
+
+void sigfn::defer(int signum, sigfn::handler_function &&handler, sigfn::thread_pool &pool, sigfn::priority level)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    if (level != sigfn::priority::high && level != sigfn::priority::normal && level != sigfn::priority::low)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_priority);
+    }
+    internal::state::deferred_dispatcher.start();
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(std::move(handler), pool._pool.get(), level));
+}
+
+void sigfn::coalesce(int signum, const sigfn::batch_function &handler, const std::chrono::steady_clock::duration &window, std::uint64_t threshold)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::deferred_dispatcher.start();
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(handler, window, threshold));
+}
+
+void sigfn::coalesce(int signum, sigfn::batch_function &&handler, const std::chrono::steady_clock::duration &window, std::uint64_t threshold)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    internal::state::deferred_dispatcher.start();
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(std::move(handler), window, threshold));
+}
+
+sigfn::handler_token sigfn::attach(int signum, const sigfn::handler_function &handler)
+{
+    return sigfn::attach(signum, sigfn::handler_function(handler));
+}
+
+sigfn::handler_token sigfn::attach(int signum, sigfn::handler_function &&handler)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
+    }
+    return internal::state::handler_table.attach(signum, new internal::handler_entry(std::move(handler)));
+}
+
+sigfn::handler_token sigfn::attach_deferred(int signum, const sigfn::handler_function &handler)
+{
+    return sigfn::attach_deferred(signum, sigfn::handler_function(handler));
+}
+
+sigfn::handler_token sigfn::attach_deferred(int signum, sigfn::handler_function &&handler)
+{
+    if (!handler)
+    {
+        throw sigfn::internal::error(sigfn::internal::invalid_handler);
     }
-    internal::state::hook(signum, internal::state::callback);
-    internal::state::handler_map[signum] = std::move(handler);
+    internal::state::deferred_dispatcher.start();
+    return internal::state::handler_table.attach(signum, new internal::handler_entry(std::move(handler), internal::dispatch_mode::deferred));
+}
+
+bool sigfn::detach(sigfn::handler_token token)
+{
+    return internal::state::handler_table.detach(token);
+}
+
+void sigfn::watch(int signum)
+{
+    internal::state::attach(signum, sigfn::restart);
+    internal::state::handler_table.store(signum, new internal::handler_entry(internal::dispatch_mode::polled));
+}
+
+std::uint64_t sigfn::poll()
+{
+    return internal::state::watched.take();
+}
+
+bool sigfn::pending(int signum)
+{
+    return signum > 0 && signum < internal::signal_count && internal::state::watched.test(signum);
 }
 
 void sigfn::ignore(int signum)
 {
     internal::state::hook(signum, SIG_IGN);
-    static_cast<void>(sigfn::internal::state::handler_map.erase(signum));
+    internal::state::handler_table.clear(signum);
 }
 
 void sigfn::reset(int signum)
 {
     internal::state::hook(signum, SIG_DFL);
-    static_cast<void>(sigfn::internal::state::handler_map.erase(signum));
+    internal::state::handler_table.clear(signum);
 }
 
 int sigfn::wait(std::initializer_list<int> signums)
@@ -132,6 +399,107 @@ int sigfn_handle(int signum, sigfn_handler_func handler, void *userdata)
     return sigfn::internal::try_catch_return(sigfn::internal::handle, signum, handler, userdata);
 }
 
+#ifndef _WIN32
+int sigfn_handle_info(int signum, sigfn_info_handler_func handler, void *userdata, int flags)
+{
+    return sigfn::internal::try_catch_return(sigfn::internal::handle_info, signum, handler, userdata, flags);
+}
+#endif
+
+int sigfn_defer(int signum, sigfn_handler_func handler, void *userdata)
+{
+    return sigfn::internal::try_catch_return(sigfn::internal::defer, signum, handler, userdata);
+}
+
+int sigfn_coalesce(int signum, sigfn_batch_func handler, void *userdata, const struct timeval *window, uint64_t threshold)
+{
+    return sigfn::internal::try_catch_return(sigfn::internal::coalesce, signum, handler, userdata, window, threshold);
+}
+
+int sigfn_attach(int signum, sigfn_handler_func handler, void *userdata, sigfn_token *token)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            const sigfn::handler_token result = sigfn::attach(signum, sigfn::internal::make_handler(handler, userdata));
+            if (token != nullptr)
+            {
+                *token = result;
+            }
+        });
+}
+
+int sigfn_attach_deferred(int signum, sigfn_handler_func handler, void *userdata, sigfn_token *token)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            const sigfn::handler_token result = sigfn::attach_deferred(signum, sigfn::internal::make_handler(handler, userdata));
+            if (token != nullptr)
+            {
+                *token = result;
+            }
+        });
+}
+
+int sigfn_detach(sigfn_token token)
+{
+    bool removed(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            removed = sigfn::detach(token);
+        });
+    if (result == 0 && !removed)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+int sigfn_watch(int signum)
+{
+    return sigfn::internal::try_catch_return(sigfn::watch, signum);
+}
+
+uint64_t sigfn_poll()
+{
+    return sigfn::poll();
+}
+
+int sigfn_pending(int signum)
+{
+    return sigfn::pending(signum) ? 1 : 0;
+}
+
+int sigfn_rate_limit(int signum, double rate, uint64_t burst)
+{
+    return sigfn::internal::try_catch_return(sigfn::rate_limit, signum, rate, burst);
+}
+
+int sigfn_throttle(int signum, const struct timeval *interval)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            sigfn::throttle(signum, std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(interval)));
+        });
+}
+
+int sigfn_debounce(int signum, const struct timeval *interval)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            sigfn::debounce(signum, std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(interval)));
+        });
+}
+
+int sigfn_unlimit(int signum)
+{
+    return sigfn::internal::try_catch_return(sigfn::unlimit, signum);
+}
+
 int sigfn_ignore(int signum)
 {
     return sigfn::internal::try_catch_return(sigfn::ignore, signum);
@@ -144,12 +512,11 @@ int sigfn_reset(int signum)
 
 int sigfn_wait(const int *signums, size_t count, int *received)
 {
-    std::vector<int> signums_vec(signums, signums + count);
     return sigfn::internal::try_catch_return(
         [&]()
         {
             int signum(-1);
-            sigfn::internal::wait(signums_vec.begin(), signums_vec.end(), signum);
+            sigfn::internal::wait(signums, signums + count, signum);
             if (received != nullptr)
             {
                 *received = signum;
@@ -160,12 +527,11 @@ int sigfn_wait(const int *signums, size_t count, int *received)
 int sigfn_wait_for(const int *signums, size_t count, int *received, const struct timeval *timeout)
 {
     bool finished(false);
-    std::vector<int> signums_vec(signums, signums + count);
     int result = sigfn::internal::try_catch_return(
         [&]()
         {
             int signum(-1);
-            finished = sigfn::internal::wait_for(signums_vec.begin(), signums_vec.end(), signum, sigfn::internal::make_duration(timeout));
+            finished = sigfn::internal::wait_for(signums, signums + count, signum, sigfn::internal::make_duration(timeout));
             if (finished && received != nullptr)
             {
                 *received = signum;
@@ -181,12 +547,77 @@ int sigfn_wait_for(const int *signums, size_t count, int *received, const struct
 int sigfn_wait_until(const int *signums, size_t count, int *received, const struct timeval *deadline)
 {
     bool finished(false);
-    std::vector<int> signums_vec(signums, signums + count);
     int result = sigfn::internal::try_catch_return(
         [&]()
         {
             int signum(-1);
-            finished = sigfn::internal::wait_until(signums_vec.begin(), signums_vec.end(), signum, sigfn::internal::make_time_point(deadline));
+            finished = sigfn::internal::wait_until(signums, signums + count, signum, sigfn::internal::make_time_point(deadline));
+            if (finished && received != nullptr)
+            {
+                *received = signum;
+            }
+        });
+    if (result == 0 && !finished)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+struct sigfn_stop_source
+{
+    sigfn::stop_source source;
+};
+
+int sigfn_stop_source_create(const int *signums, size_t count, sigfn_stop_source **source)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_stop);
+            }
+            *source = new sigfn_stop_source{sigfn::stop_source(signums, count)};
+        });
+}
+
+int sigfn_stop_requested(const sigfn_stop_source *source)
+{
+    return (source != nullptr && source->source.stop_requested()) ? 1 : 0;
+}
+
+int sigfn_stop_request(sigfn_stop_source *source)
+{
+    bool first(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_stop);
+            }
+            first = source->source.request_stop();
+        });
+    if (result == 0 && !first)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+int sigfn_wait_stoppable(const int *signums, size_t count, int *received, const sigfn_stop_source *source)
+{
+    bool finished(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_stop);
+            }
+            int signum(-1);
+            finished = sigfn::internal::wait_stoppable(signums, count, signum, source->source.get_token());
             if (finished && received != nullptr)
             {
                 *received = signum;
@@ -199,12 +630,744 @@ int sigfn_wait_until(const int *signums, size_t count, int *received, const stru
     return result;
 }
 
+void sigfn_stop_source_destroy(sigfn_stop_source *source)
+{
+    delete source;
+}
+
+struct sigfn_shutdown
+{
+    sigfn::shutdown_orchestrator orchestrator;
+};
+
+namespace
+{
+    void copy_timings(const std::vector<sigfn::shutdown_timing> &report, sigfn_shutdown_timing *timings, size_t max, size_t *count)
+    {
+        if (timings == nullptr && max > 0)
+        {
+            throw sigfn::internal::error(sigfn::internal::invalid_shutdown);
+        }
+        const size_t copied = std::min(report.size(), max);
+        for (size_t index = 0; index < copied; index++)
+        {
+            std::strncpy(timings[index].name, report[index].name.c_str(), SIGFN_SHUTDOWN_NAME_MAX - 1);
+            timings[index].name[SIGFN_SHUTDOWN_NAME_MAX - 1] = '\0';
+            timings[index].stage = report[index].stage;
+            timings[index].status = static_cast<int>(report[index].status);
+            timings[index].elapsed_ns = static_cast<uint64_t>(report[index].elapsed.count());
+        }
+        if (count != nullptr)
+        {
+            *count = copied;
+        }
+    }
+}
+
+int sigfn_shutdown_create(const int *signums, size_t count, sigfn_callback_func escalate, void *userdata, sigfn_shutdown **shutdown)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (shutdown == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_shutdown);
+            }
+            sigfn::shutdown_orchestrator::escalate_function escalate_function;
+            if (escalate != nullptr)
+            {
+                escalate_function = [escalate, userdata]()
+                {
+                    escalate(userdata);
+                };
+            }
+            *shutdown = new sigfn_shutdown{sigfn::shutdown_orchestrator(signums, count, std::move(escalate_function))};
+        });
+}
+
+int sigfn_shutdown_add(sigfn_shutdown *shutdown, const char *name, int stage, const struct timeval *timeout, sigfn_callback_func drain, void *userdata)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (shutdown == nullptr || name == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_shutdown);
+            }
+            std::function<void()> drain_function;
+            if (drain != nullptr)
+            {
+                drain_function = [drain, userdata]()
+                {
+                    drain(userdata);
+                };
+            }
+            shutdown->orchestrator.add(name, stage, std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(timeout)), std::move(drain_function));
+        });
+}
+
+int sigfn_shutdown_wait(sigfn_shutdown *shutdown, sigfn_shutdown_timing *timings, size_t max, size_t *count)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (shutdown == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_shutdown);
+            }
+            copy_timings(shutdown->orchestrator.wait(), timings, max, count);
+        });
+}
+
+int sigfn_shutdown_run(sigfn_shutdown *shutdown, sigfn_shutdown_timing *timings, size_t max, size_t *count)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (shutdown == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_shutdown);
+            }
+            copy_timings(shutdown->orchestrator.run(), timings, max, count);
+        });
+}
+
+void sigfn_shutdown_destroy(sigfn_shutdown *shutdown)
+{
+    delete shutdown;
+}
+
+struct sigfn_event_source
+{
+    sigfn::event_source source;
+};
+
+int sigfn_event_source_create(const int *signums, size_t count, sigfn_event_source **source)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_source);
+            }
+            *source = new sigfn_event_source{sigfn::event_source(signums, count)};
+        });
+}
+
+int sigfn_event_source_fd(const sigfn_event_source *source)
+{
+    int fd(-1);
+    static_cast<void>(sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_source);
+            }
+            fd = source->source.fd();
+        }));
+    return fd;
+}
+
+int sigfn_event_source_dispatch(sigfn_event_source *source, size_t *dispatched)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (source == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_source);
+            }
+            const std::size_t count = source->source.dispatch();
+            if (dispatched != nullptr)
+            {
+                *dispatched = count;
+            }
+        });
+}
+
+void sigfn_event_source_destroy(sigfn_event_source *source)
+{
+    delete source;
+}
+
+struct sigfn_thread_pool
+{
+    sigfn::thread_pool pool;
+};
+
+int sigfn_thread_pool_create(size_t workers, sigfn_thread_pool **pool)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (pool == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_pool);
+            }
+            *pool = new sigfn_thread_pool{sigfn::thread_pool(workers)};
+        });
+}
+
+int sigfn_defer_pool(int signum, sigfn_handler_func handler, void *userdata, sigfn_thread_pool *pool, int priority)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (pool == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_pool);
+            }
+            sigfn::handler_function handler_function = sigfn::internal::make_handler(handler, userdata);
+            sigfn::defer(signum, std::move(handler_function), pool->pool, static_cast<sigfn::priority>(priority));
+        });
+}
+
+void sigfn_thread_pool_destroy(sigfn_thread_pool *pool)
+{
+    delete pool;
+}
+
+#ifndef _WIN32
+struct sigfn_realtime_queue
+{
+    sigfn::realtime_queue queue;
+};
+
+int sigfn_realtime_queue_create(const int *signums, size_t count, size_t capacity, sigfn_realtime_queue **queue)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (queue == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_queue);
+            }
+            *queue = new sigfn_realtime_queue{sigfn::realtime_queue(signums, count, capacity)};
+        });
+}
+
+int sigfn_realtime_queue_drain(sigfn_realtime_queue *queue, sigfn_queued_signal *signals, size_t max, size_t *drained)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (queue == nullptr || (signals == nullptr && max > 0))
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_queue);
+            }
+            sigfn::queued_signal signal;
+            size_t count(0);
+            while (count < max && queue->queue.drain(&signal, 1) == 1)
+            {
+                signals[count] = {signal.signum, signal.code, signal.pid, signal.uid, signal.value};
+                count++;
+            }
+            if (drained != nullptr)
+            {
+                *drained = count;
+            }
+        });
+}
+
+uint64_t sigfn_realtime_queue_overflows(const sigfn_realtime_queue *queue)
+{
+    return (queue != nullptr) ? queue->queue.overflows() : 0;
+}
+
+void sigfn_realtime_queue_destroy(sigfn_realtime_queue *queue)
+{
+    delete queue;
+}
+
+struct sigfn_child_watcher
+{
+    sigfn::child_watcher watcher;
+};
+
+int sigfn_child_watcher_create(sigfn_child_watcher **watcher)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (watcher == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_watcher);
+            }
+            *watcher = new sigfn_child_watcher;
+        });
+}
+
+int sigfn_child_watch(sigfn_child_watcher *watcher, pid_t pid, sigfn_child_func callback, void *userdata)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (watcher == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_watcher);
+            }
+            if (callback == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_handler);
+            }
+            watcher->watcher.watch(
+                pid,
+                [callback, userdata](const sigfn::child_exit &exit)
+                {
+                    const sigfn_child_exit record = {exit.pid, exit.code, exit.status, exit.usage};
+                    callback(&record, userdata);
+                });
+        });
+}
+
+int sigfn_child_unwatch(sigfn_child_watcher *watcher, pid_t pid)
+{
+    bool watched(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (watcher == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_watcher);
+            }
+            watched = watcher->watcher.unwatch(pid);
+        });
+    if (result == 0 && !watched)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+int sigfn_child_reap(sigfn_child_watcher *watcher, size_t *reaped)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (watcher == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_watcher);
+            }
+            const size_t count = watcher->watcher.reap();
+            if (reaped != nullptr)
+            {
+                *reaped = count;
+            }
+        });
+}
+
+void sigfn_child_watcher_destroy(sigfn_child_watcher *watcher)
+{
+    delete watcher;
+}
+
+struct sigfn_timer_wheel
+{
+    sigfn::timer_wheel wheel;
+};
+
+int sigfn_timer_wheel_create(int signum, const struct timeval *tick, sigfn_timer_wheel **wheel)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (wheel == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_timer);
+            }
+            *wheel = new sigfn_timer_wheel{sigfn::timer_wheel(signum, std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(tick)))};
+        });
+}
+
+int sigfn_timer_schedule(sigfn_timer_wheel *wheel, const struct timeval *after, const struct timeval *period, sigfn_timer_func callback, void *userdata, sigfn_timer_id *id)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (wheel == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_timer);
+            }
+            if (callback == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_handler);
+            }
+            const sigfn::timer_id scheduled = wheel->wheel.schedule(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(after)),
+                [callback, userdata](sigfn::timer_id fired, std::uint64_t overruns)
+                {
+                    callback(fired, overruns, userdata);
+                },
+                (period != nullptr) ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(sigfn::internal::make_duration(period)) : std::chrono::steady_clock::duration::zero());
+            if (id != nullptr)
+            {
+                *id = scheduled;
+            }
+        });
+}
+
+int sigfn_timer_cancel(sigfn_timer_wheel *wheel, sigfn_timer_id id)
+{
+    bool cancelled(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (wheel == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_timer);
+            }
+            cancelled = wheel->wheel.cancel(id);
+        });
+    if (result == 0 && !cancelled)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+void sigfn_timer_wheel_destroy(sigfn_timer_wheel *wheel)
+{
+    delete wheel;
+}
+
+struct sigfn_thread_interrupter
+{
+    sigfn::thread_interrupter interrupter;
+};
+
+struct sigfn_interrupt_scope
+{
+    sigfn::interrupt_scope scope;
+};
+
+int sigfn_thread_interrupter_create(int signum, sigfn_thread_interrupter **interrupter)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (interrupter == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_interrupter);
+            }
+            *interrupter = new sigfn_thread_interrupter{sigfn::thread_interrupter(signum)};
+        });
+}
+
+int sigfn_thread_interrupt(sigfn_thread_interrupter *interrupter, sigfn_thread_token token)
+{
+    bool registered(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (interrupter == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_interrupter);
+            }
+            registered = interrupter->interrupter.interrupt(token);
+        });
+    if (result == 0 && !registered)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+void sigfn_thread_interrupter_destroy(sigfn_thread_interrupter *interrupter)
+{
+    delete interrupter;
+}
+
+int sigfn_interrupt_enter(sigfn_thread_interrupter *interrupter, sigfn_handler_func callback, void *userdata, sigfn_thread_token *token, sigfn_interrupt_scope **scope)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (interrupter == nullptr || scope == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_interrupter);
+            }
+            sigfn::handler_function function;
+            if (callback != nullptr)
+            {
+                function = [callback, userdata](int signum)
+                {
+                    callback(signum, userdata);
+                };
+            }
+            *scope = new sigfn_interrupt_scope{sigfn::interrupt_scope(interrupter->interrupter, std::move(function))};
+            if (token != nullptr)
+            {
+                *token = (*scope)->scope.token();
+            }
+        });
+}
+
+int sigfn_interrupted(const sigfn_interrupt_scope *scope)
+{
+    return (scope != nullptr && scope->scope.interrupted()) ? 1 : 0;
+}
+
+int sigfn_interrupt_reset(sigfn_interrupt_scope *scope)
+{
+    bool interrupted(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (scope == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_interrupter);
+            }
+            interrupted = scope->scope.reset();
+        });
+    if (result == 0 && interrupted)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+void sigfn_interrupt_leave(sigfn_interrupt_scope *scope)
+{
+    delete scope;
+}
+#endif
+
+static_assert(static_cast<int>(sigfn::shutdown_status::skipped) == SIGFN_SHUTDOWN_SKIPPED, "sigfn: shutdown status mismatch");
+static_assert(sigfn::signal_bit(2) == SIGFN_SIGNAL_BIT(2), "sigfn: signal bit mismatch");
+static_assert(sigfn::histogram_buckets == SIGFN_HISTOGRAM_BUCKETS, "sigfn: histogram bucket count mismatch");
+
+int sigfn_stats(int signum, sigfn_signal_stats *stats)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (stats == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_stats);
+            }
+            const sigfn::signal_stats snapshot = sigfn::stats(signum);
+            stats->signum = snapshot.signum;
+            stats->deliveries = snapshot.deliveries;
+            stats->invocations = snapshot.invocations;
+            stats->handler_ns = static_cast<uint64_t>(snapshot.handler_time.count());
+            stats->max_handler_ns = static_cast<uint64_t>(snapshot.max_handler_time.count());
+            stats->coalesced = snapshot.coalesced;
+            stats->dropped = snapshot.dropped;
+            stats->suppressed = snapshot.suppressed;
+            std::copy(snapshot.histogram.begin(), snapshot.histogram.end(), stats->histogram);
+        });
+}
+
+int sigfn_stats_reset()
+{
+    return sigfn::internal::try_catch_return(sigfn::reset_stats);
+}
+
+#ifndef _WIN32
+int sigfn_trace_start(size_t threads, size_t capacity)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            sigfn::trace_start(threads, capacity);
+        });
+}
+
+int sigfn_trace_stop()
+{
+    return sigfn::internal::try_catch_return(sigfn::trace_stop);
+}
+
+int sigfn_trace_dump(int fd, int format)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            sigfn::trace_dump(fd, sigfn::internal::make_trace_format(format));
+        });
+}
+
+int sigfn_trace_dump_on(int signum, int fd, int format, sigfn_token *token)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            const sigfn::handler_token result = sigfn::trace_dump_on(signum, fd, sigfn::internal::make_trace_format(format));
+            if (token != nullptr)
+            {
+                *token = result;
+            }
+        });
+}
+
+int sigfn_crash_install(int fd, const int *signums, size_t count)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (signums == nullptr)
+            {
+                sigfn::crash_install(fd);
+            }
+            else
+            {
+                sigfn::crash_install(fd, signums, count);
+            }
+        });
+}
+
+int sigfn_crash_thread_init()
+{
+    return sigfn::internal::try_catch_return(sigfn::crash_thread_init);
+}
+
+int sigfn_crash_uninstall()
+{
+    return sigfn::internal::try_catch_return(sigfn::crash_uninstall);
+}
+
+struct sigfn_profiler
+{
+    sigfn::profiler profiler;
+};
+
+int sigfn_profiler_create(unsigned int frequency, size_t threads, size_t capacity, sigfn_profiler **profiler)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            *profiler = new sigfn_profiler{sigfn::profiler(frequency, threads, capacity)};
+        });
+}
+
+int sigfn_profiler_start(sigfn_profiler *profiler)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            profiler->profiler.start();
+        });
+}
+
+int sigfn_profiler_stop(sigfn_profiler *profiler)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            profiler->profiler.stop();
+        });
+}
+
+int sigfn_profiler_counts(sigfn_profiler *profiler, uint64_t *samples, uint64_t *dropped)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            if (samples != nullptr)
+            {
+                *samples = profiler->profiler.samples();
+            }
+            if (dropped != nullptr)
+            {
+                *dropped = profiler->profiler.dropped();
+            }
+        });
+}
+
+int sigfn_profiler_dump(sigfn_profiler *profiler, int fd)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            profiler->profiler.dump(fd);
+        });
+}
+
+int sigfn_profiler_clear(sigfn_profiler *profiler)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (profiler == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_profiler);
+            }
+            profiler->profiler.clear();
+        });
+}
+
+void sigfn_profiler_destroy(sigfn_profiler *profiler)
+{
+    delete profiler;
+}
+
+int sigfn_sigpipe_suppress(sigfn_sigpipe_guard *guard)
+{
+    return sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (guard == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_sigpipe);
+            }
+            bool nested(false);
+            bool restore(false);
+            bool pending(false);
+            sigfn::internal::sigpipe_block(nested, restore, pending);
+            guard->nested = nested;
+            guard->restore = restore;
+            guard->pending = pending;
+        });
+}
+
+int sigfn_sigpipe_restore(sigfn_sigpipe_guard *guard)
+{
+    bool consumed(false);
+    int result = sigfn::internal::try_catch_return(
+        [&]()
+        {
+            if (guard == nullptr)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_sigpipe);
+            }
+            consumed = sigfn::internal::sigpipe_release(guard->nested != 0, guard->restore != 0, guard->pending != 0);
+        });
+    if (result == 0 && consumed)
+    {
+        result = 1;
+    }
+    return result;
+}
+#endif
+
 const char *sigfn_error()
 {
     const char *result(nullptr);
-    if (!sigfn::internal::state::error_message.empty())
+    if (sigfn::internal::state::error_message[0] != '\0')
     {
-        result = sigfn::internal::state::error_message.c_str();
+        result = sigfn::internal::state::error_message.data();
     }
     return result;
 }
\ No newline at end of file
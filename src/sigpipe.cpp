@@ -0,0 +1,103 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+#include <ctime>
+#include <pthread.h>
+
+namespace
+{
+    // depth of suppress_sigpipe scopes on the calling thread
+    thread_local unsigned int sigpipe_depth(0);
+
+    sigset_t sigpipe_set()
+    {
+        sigset_t sigset;
+        sigemptyset(&sigset);
+        sigaddset(&sigset, SIGPIPE);
+        return sigset;
+    }
+}
+
+void sigfn::internal::sigpipe_block(bool &nested, bool &restore, bool &pending)
+{
+    nested = (sigpipe_depth > 0);
+    restore = false;
+    pending = false;
+    if (!nested)
+    {
+        const sigset_t sigset = sigpipe_set();
+        sigset_t previous;
+        if (pthread_sigmask(SIG_BLOCK, &sigset, &previous) != 0)
+        {
+            throw error(invalid_sigpipe);
+        }
+        restore = (sigismember(&previous, SIGPIPE) == 0);
+        // an unblocked SIGPIPE cannot be pending, so only a thread that
+        // already blocked it needs to look
+        sigset_t waiting;
+        if (!restore && sigpending(&waiting) == 0)
+        {
+            pending = (sigismember(&waiting, SIGPIPE) == 1);
+        }
+    }
+    sigpipe_depth++;
+}
+
+bool sigfn::internal::sigpipe_release(bool nested, bool restore, bool pending)
+{
+    bool consumed(false);
+    sigpipe_depth--;
+    if (!nested)
+    {
+        const sigset_t sigset = sigpipe_set();
+        sigset_t waiting;
+        if (!pending && sigpending(&waiting) == 0 && sigismember(&waiting, SIGPIPE) == 1)
+        {
+#ifdef SIGFN_SIGTIMEDWAIT
+            const struct timespec timeout = {0, 0};
+            consumed = (sigtimedwait(&sigset, nullptr, &timeout) == SIGPIPE);
+#else
+            // known to be pending, so this does not block
+            int signum(0);
+            consumed = (sigwait(&sigset, &signum) == 0);
+#endif
+        }
+        if (restore)
+        {
+            pthread_sigmask(SIG_UNBLOCK, &sigset, nullptr);
+        }
+    }
+    return consumed;
+}
+
+sigfn::suppress_sigpipe::suppress_sigpipe()
+{
+    internal::sigpipe_block(_nested, _restore, _pending);
+}
+
+sigfn::suppress_sigpipe::~suppress_sigpipe()
+{
+    internal::sigpipe_release(_nested, _restore, _pending);
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+namespace
+{
+    // floor(log2(nanoseconds)), with zero in the first bucket and anything
+    // past the last bucket clamped into it
+    std::size_t bucket(std::uint64_t nanoseconds)
+    {
+        std::size_t index(0);
+        while (nanoseconds > 1 && index < sigfn::histogram_buckets - 1)
+        {
+            nanoseconds >>= 1;
+            index++;
+        }
+        return index;
+    }
+}
+
+void sigfn::internal::stats_table::delivered(int signum)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        _counters[signum].deliveries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void sigfn::internal::stats_table::invoked(int signum, std::uint64_t nanoseconds)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        counters &counters = _counters[signum];
+        counters.invocations.fetch_add(1, std::memory_order_relaxed);
+        counters.handler_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+        counters.histogram[bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t max = counters.max_handler_ns.load(std::memory_order_relaxed);
+        while (max < nanoseconds && !counters.max_handler_ns.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+void sigfn::internal::stats_table::coalesced(int signum)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        _counters[signum].coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void sigfn::internal::stats_table::dropped(int signum)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        _counters[signum].dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void sigfn::internal::stats_table::suppressed(int signum)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        _counters[signum].suppressed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+sigfn::signal_stats sigfn::internal::stats_table::snapshot(int signum) const
+{
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_signum);
+    }
+    const counters &counters = _counters[signum];
+    sigfn::signal_stats snapshot;
+    snapshot.signum = signum;
+    snapshot.deliveries = counters.deliveries.load(std::memory_order_relaxed);
+    snapshot.invocations = counters.invocations.load(std::memory_order_relaxed);
+    snapshot.handler_time = std::chrono::nanoseconds(counters.handler_ns.load(std::memory_order_relaxed));
+    snapshot.max_handler_time = std::chrono::nanoseconds(counters.max_handler_ns.load(std::memory_order_relaxed));
+    snapshot.coalesced = counters.coalesced.load(std::memory_order_relaxed);
+    snapshot.dropped = counters.dropped.load(std::memory_order_relaxed);
+    snapshot.suppressed = counters.suppressed.load(std::memory_order_relaxed);
+    for (std::size_t index = 0; index < histogram_buckets; index++)
+    {
+        snapshot.histogram[index] = counters.histogram[index].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void sigfn::internal::stats_table::clear()
+{
+    for (counters &counters : _counters)
+    {
+        counters.deliveries.store(0, std::memory_order_relaxed);
+        counters.invocations.store(0, std::memory_order_relaxed);
+        counters.handler_ns.store(0, std::memory_order_relaxed);
+        counters.max_handler_ns.store(0, std::memory_order_relaxed);
+        counters.coalesced.store(0, std::memory_order_relaxed);
+        counters.dropped.store(0, std::memory_order_relaxed);
+        counters.suppressed.store(0, std::memory_order_relaxed);
+        for (std::atomic<std::uint64_t> &bucket : counters.histogram)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+sigfn::signal_stats sigfn::stats(int signum)
+{
+    return internal::state::statistics.snapshot(signum);
+}
+
+std::vector<sigfn::signal_stats> sigfn::stats()
+{
+    std::vector<signal_stats> snapshots;
+    for (int signum = 1; signum < internal::signal_count; signum++)
+    {
+        signal_stats snapshot = internal::state::statistics.snapshot(signum);
+        if (snapshot.deliveries > 0 || snapshot.invocations > 0)
+        {
+            snapshots.push_back(snapshot);
+        }
+    }
+    return snapshots;
+}
+
+void sigfn::reset_stats()
+{
+    internal::state::statistics.clear();
+}
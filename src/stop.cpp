@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+bool sigfn::internal::stop_state::request()
+{
+    const bool first = !requested.exchange(true);
+    notify();
+    return first;
+}
+
+void sigfn::internal::stop_state::notify()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_notified)
+    {
+        _notified = true;
+        requested.store(true);
+#ifdef SIGFN_SIGTIMEDWAIT
+        // every stop signal is part of a stoppable wait, so any of them wakes it
+        for (const pthread_t thread : _threads)
+        {
+            pthread_kill(thread, signums.front());
+        }
+#endif
+        while (!_callbacks.empty())
+        {
+            sigfn::stop_callback *const callback = _callbacks.back();
+            _callbacks.pop_back();
+            _running = callback;
+            _runner = std::this_thread::get_id();
+            lock.unlock();
+            try
+            {
+                callback->_callback();
+            }
+            catch (...)
+            {
+                // one failing callback must not keep the others from running
+            }
+            lock.lock();
+            _running = nullptr;
+            _finished.notify_all();
+        }
+    }
+}
+
+void sigfn::internal::stop_state::add(sigfn::stop_callback *callback)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_notified)
+    {
+        lock.unlock();
+        callback->_callback();
+    }
+    else
+    {
+        _callbacks.push_back(callback);
+    }
+}
+
+void sigfn::internal::stop_state::remove(sigfn::stop_callback *callback)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const std::vector<sigfn::stop_callback *>::iterator found = std::find(_callbacks.begin(), _callbacks.end(), callback);
+    if (found != _callbacks.end())
+    {
+        _callbacks.erase(found);
+    }
+    else
+    {
+        // a callback may unregister itself, otherwise wait for it to return
+        _finished.wait(
+            lock,
+            [&]()
+            {
+                return _running != callback || _runner == std::this_thread::get_id();
+            });
+    }
+}
+
+#ifdef SIGFN_SIGTIMEDWAIT
+bool sigfn::internal::stop_state::enter(pthread_t thread)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_notified)
+    {
+        _threads.push_back(thread);
+    }
+    return !_notified;
+}
+
+void sigfn::internal::stop_state::leave(pthread_t thread)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _threads.erase(
+        std::remove_if(
+            _threads.begin(),
+            _threads.end(),
+            [&](pthread_t registered)
+            {
+                return pthread_equal(registered, thread) != 0;
+            }),
+        _threads.end());
+}
+#endif
+
+sigfn::stop_source::stop_source(std::initializer_list<int> signums) : stop_source(signums.begin(), signums.size())
+{
+}
+
+sigfn::stop_source::stop_source(const int *signums, std::size_t count)
+{
+    if (signums == nullptr || count == 0)
+    {
+        throw internal::error(internal::empty_sigset);
+    }
+    _state = std::make_shared<internal::stop_state>(std::vector<int>(signums, signums + count));
+    const std::shared_ptr<internal::stop_state> state = _state;
+    try
+    {
+        for (std::size_t index = 0; index < count; index++)
+        {
+            // the entries keep the state alive until no delivery can reach them
+            _tokens.push_back(sigfn::attach(
+                signums[index],
+                [state](int)
+                {
+                    state->raise();
+                }));
+            _tokens.push_back(sigfn::attach_deferred(
+                signums[index],
+                [state](int)
+                {
+                    state->notify();
+                }));
+        }
+    }
+    catch (...)
+    {
+        for (const handler_token token : _tokens)
+        {
+            sigfn::detach(token);
+        }
+        throw;
+    }
+}
+
+sigfn::stop_source::~stop_source()
+{
+    for (const handler_token token : _tokens)
+    {
+        sigfn::detach(token);
+    }
+}
+
+sigfn::stop_token sigfn::stop_source::get_token() const
+{
+    stop_token token;
+    token._state = _state;
+    token._requested = &_state->requested;
+    return token;
+}
+
+bool sigfn::stop_source::stop_requested() const noexcept
+{
+    return _state->requested.load(std::memory_order_acquire);
+}
+
+bool sigfn::stop_source::request_stop()
+{
+    return _state->request();
+}
+
+sigfn::stop_callback::stop_callback(const stop_token &token, std::function<void()> callback)
+    : _state(token._state), _callback(std::move(callback))
+{
+    if (!_callback)
+    {
+        throw internal::error(internal::invalid_handler);
+    }
+    if (_state != nullptr)
+    {
+        _state->add(this);
+    }
+}
+
+sigfn::stop_callback::~stop_callback()
+{
+    if (_state != nullptr)
+    {
+        _state->remove(this);
+    }
+}
+
+std::optional<int> sigfn::wait(std::initializer_list<int> signums, const stop_token &token)
+{
+    std::optional<int> result;
+    int signum(-1);
+    if (internal::wait_stoppable(signums.begin(), signums.size(), signum, token))
+    {
+        result = signum;
+    }
+    return result;
+}
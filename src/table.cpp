@@ -0,0 +1,821 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+namespace
+{
+    // deliveries the calling thread is inside of, such a thread must not
+    // wait for the epoch to advance
+    thread_local unsigned int reader_depth(0);
+
+    // pins the current epoch for the lifetime of a single delivery
+    class reader_guard
+    {
+    public:
+        reader_guard(std::atomic<std::uint64_t> &epoch, std::array<std::atomic<std::uint64_t>, 2> &readers)
+            : _readers(readers[epoch.load() & 1])
+        {
+            _readers.fetch_add(1);
+            reader_depth++;
+        }
+
+        ~reader_guard()
+        {
+            reader_depth--;
+            _readers.fetch_sub(1);
+        }
+
+    private:
+        std::atomic<std::uint64_t> &_readers;
+    };
+
+    // records the duration of one handler invocation, including one that
+    // throws, in the statistics and the trace
+    class invocation_timer
+    {
+    public:
+        invocation_timer(int signum, const siginfo_t *info, bool delivered)
+            : _signum(signum), _info(info), _delivered(delivered), _start(sigfn::internal::monotonic_ns())
+        {
+        }
+
+        ~invocation_timer()
+        {
+            const std::uint64_t end = sigfn::internal::monotonic_ns();
+            sigfn::internal::state::statistics.invoked(_signum, end - _start);
+#ifndef _WIN32
+            if (sigfn::internal::state::tracer.enabled())
+            {
+                sigfn::internal::state::tracer.record(_signum, sigfn::internal::sender_of(_info), _delivered ? _start : 0, _start, end);
+            }
+#endif
+        }
+
+    private:
+        const int _signum;
+        const siginfo_t *const _info;
+        const bool _delivered;
+        const std::uint64_t _start;
+    };
+
+    // traces a delivery whose handler runs later, if at all
+    void trace_delivery(int signum, const siginfo_t *info)
+    {
+#ifndef _WIN32
+        if (sigfn::internal::state::tracer.enabled())
+        {
+            sigfn::internal::state::tracer.record(signum, sigfn::internal::sender_of(info), sigfn::internal::monotonic_ns(), 0, 0);
+        }
+#else
+        static_cast<void>(signum);
+        static_cast<void>(info);
+#endif
+    }
+
+    // frees the retired objects of one list that no reader can still observe
+    template <class T>
+    void sweep(T *&retired, std::uint64_t epoch)
+    {
+        T **link = &retired;
+        while (*link != nullptr)
+        {
+            T *const object = *link;
+            if (object->retired_epoch + 2 <= epoch)
+            {
+                *link = object->retired_next;
+                delete object;
+            }
+            else
+            {
+                link = &object->retired_next;
+            }
+        }
+    }
+
+    // tokens carry the signal number in their low byte
+    static_assert(sigfn::internal::signal_count <= 256, "sigfn: signal numbers do not fit in a token");
+}
+
+void sigfn::internal::handler_entry::invoke(int signum, const siginfo_t *info) const
+{
+    if (mode == dispatch_mode::polled)
+    {
+        state::watched.set(signum);
+    }
+    else if (mode == dispatch_mode::coalesced)
+    {
+        // a synchronous delivery is a batch of one
+        batch_function(signum, 1);
+    }
+    else if (function)
+    {
+        function(signum);
+    }
+#ifndef _WIN32
+    else if (info != nullptr)
+    {
+        info_function(sigfn::signal_info(*info));
+    }
+    else
+    {
+        siginfo_t synthesized = {};
+        synthesized.si_signo = signum;
+        info_function(sigfn::signal_info(synthesized));
+    }
+#else
+    static_cast<void>(info);
+#endif
+}
+
+#ifdef SIGFN_NO_HEAP
+namespace
+{
+    // Fixed pool of objects. Free slots are threaded through the storage
+    // itself; slots past the high-water mark have never been used.
+    template <class T>
+    class object_pool
+    {
+    public:
+        void *allocate()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            void *slot(nullptr);
+            if (_free != nullptr)
+            {
+                slot = _free;
+                _free = *static_cast<void **>(_free);
+            }
+            else if (_used < sigfn::internal::entry_capacity)
+            {
+                slot = &_storage[_used++];
+            }
+            return slot;
+        }
+
+        void release(void *slot)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            *static_cast<void **>(slot) = _free;
+            _free = slot;
+        }
+
+    private:
+        std::aligned_storage_t<sizeof(T), alignof(T)> _storage[sigfn::internal::entry_capacity];
+        std::size_t _used = 0;
+        void *_free = nullptr;
+        std::mutex _mutex;
+    };
+
+    template <class T>
+    object_pool<T> &object_storage()
+    {
+        // constructed in static storage on first registration and never
+        // destroyed, so the table can release objects during static destruction
+        static std::aligned_storage_t<sizeof(object_pool<T>), alignof(object_pool<T>)> storage;
+        static object_pool<T> *const instance = ::new (static_cast<void *>(&storage)) object_pool<T>();
+        return *instance;
+    }
+
+    class pool_exhausted : public std::bad_alloc
+    {
+    public:
+        const char *what() const noexcept override
+        {
+            return sigfn::internal::pool_exhausted.c_str();
+        }
+    };
+
+    template <class T>
+    void *allocate_object(std::size_t size)
+    {
+        void *slot = (size <= sizeof(T)) ? object_storage<T>().allocate() : nullptr;
+        if (slot == nullptr && size <= sizeof(T))
+        {
+            // Retired objects only return to the pool once in-flight deliveries
+            // leave their epoch. Give them a bounded chance to do so, since a
+            // handler re-registering its own signal would otherwise wait forever.
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+            while (slot == nullptr && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+                sigfn::internal::state::handler_table.collect();
+                slot = object_storage<T>().allocate();
+            }
+        }
+        if (slot == nullptr)
+        {
+            throw ::pool_exhausted();
+        }
+        return slot;
+    }
+
+    template <class T>
+    void release_object(void *pointer) noexcept
+    {
+        if (pointer != nullptr)
+        {
+            object_storage<T>().release(pointer);
+        }
+    }
+}
+
+void *sigfn::internal::handler_entry::operator new(std::size_t size)
+{
+    return allocate_object<handler_entry>(size);
+}
+
+void sigfn::internal::handler_entry::operator delete(void *pointer) noexcept
+{
+    release_object<handler_entry>(pointer);
+}
+
+void *sigfn::internal::handler_chain::operator new(std::size_t size)
+{
+    return allocate_object<handler_chain>(size);
+}
+
+void sigfn::internal::handler_chain::operator delete(void *pointer) noexcept
+{
+    release_object<handler_chain>(pointer);
+}
+#endif
+
+sigfn::internal::dispatch_table::~dispatch_table()
+{
+#ifndef _WIN32
+    for (const std::pair<const std::uint64_t, claim_record> &claim : _claims)
+    {
+        delete claim.second.replaced;
+    }
+#endif
+    for (std::atomic<handler_entry *> &slot : _slots)
+    {
+        delete slot.exchange(nullptr);
+    }
+    for (std::atomic<handler_chain *> &slot : _chains)
+    {
+        handler_chain *const chain = slot.exchange(nullptr);
+        if (chain != nullptr)
+        {
+            for (std::size_t index = 0; index < chain->size; index++)
+            {
+                delete chain->links[index].entry;
+            }
+            delete chain;
+        }
+    }
+    while (_retired != nullptr)
+    {
+        handler_entry *const next = _retired->retired_next;
+        delete _retired;
+        _retired = next;
+    }
+    while (_retired_chains != nullptr)
+    {
+        handler_chain *const next = _retired_chains->retired_next;
+        delete _retired_chains;
+        _retired_chains = next;
+    }
+    while (_retired_pools != nullptr)
+    {
+        worker_pool *const next = _retired_pools->retired_next;
+        delete _retired_pools;
+        _retired_pools = next;
+    }
+}
+
+void sigfn::internal::dispatch_table::store(int signum, handler_entry *entry)
+{
+    if (signum <= 0 || signum >= signal_count)
+    {
+        delete entry;
+        throw error(invalid_signum);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    retire(_slots[signum].exchange(entry));
+    reclaim();
+}
+
+std::uint64_t sigfn::internal::dispatch_table::attach(int signum, handler_entry *entry)
+{
+    std::unique_ptr<handler_entry> owned(entry);
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_signum);
+    }
+    // allocated before locking, since a full chain pool collects under the lock
+    std::unique_ptr<handler_chain> chain(new handler_chain());
+    std::lock_guard<std::mutex> lock(_mutex);
+    handler_chain *const current = _chains[signum].load();
+    if (current != nullptr && current->size == chain_capacity)
+    {
+        throw error(chain_full);
+    }
+    if (current != nullptr)
+    {
+        chain->size = current->size;
+        chain->deferred = current->deferred;
+        chain->links = current->links;
+    }
+    else if (_slots[signum].load() == nullptr)
+    {
+        // first handler of the signal, keep the flags of an existing one otherwise
+        state::attach(signum, sigfn::restart);
+    }
+    const std::uint64_t token = (++_serial << 8) | static_cast<std::uint64_t>(signum);
+    chain->links[chain->size++] = {token, owned.get()};
+    chain->deferred = chain->deferred || entry->mode == dispatch_mode::deferred;
+    _chains[signum].store(chain.release());
+    owned.release();
+    retire(current);
+    reclaim();
+    return token;
+}
+
+bool sigfn::internal::dispatch_table::detach(std::uint64_t token)
+{
+    const int signum = static_cast<int>(token & 0xff);
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_token);
+    }
+    std::unique_ptr<handler_chain> chain;
+    std::unique_lock<std::mutex> lock(_mutex);
+    handler_chain *current = _chains[signum].load();
+    std::size_t found(chain_capacity);
+    for (;;)
+    {
+        for (std::size_t index = 0; current != nullptr && index < current->size; index++)
+        {
+            if (current->links[index].token == token)
+            {
+                found = index;
+            }
+        }
+        if (found == chain_capacity)
+        {
+            return false;
+        }
+        if (current->size == 1 || chain != nullptr)
+        {
+            break;
+        }
+        // allocated without the lock, since a full chain pool collects under
+        // it, then looked up again in case the chain changed meanwhile
+        lock.unlock();
+        chain.reset(new handler_chain());
+        lock.lock();
+        current = _chains[signum].load();
+        found = chain_capacity;
+    }
+    if (current->size > 1)
+    {
+        for (std::size_t index = 0; index < current->size; index++)
+        {
+            if (index != found)
+            {
+                chain->links[chain->size++] = current->links[index];
+                chain->deferred = chain->deferred || current->links[index].entry->mode == dispatch_mode::deferred;
+            }
+        }
+    }
+    else if (_slots[signum].load() == nullptr)
+    {
+        // last handler of the signal
+        state::hook(signum, SIG_DFL);
+    }
+    // a chain allocated before other links were detached goes unused
+    _chains[signum].store(current->size > 1 ? chain.release() : nullptr);
+    retire(current->links[found].entry);
+    retire(current);
+    reclaim();
+    return true;
+}
+
+void sigfn::internal::dispatch_table::clear(int signum)
+{
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_signum);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    retire(_slots[signum].exchange(nullptr));
+    handler_chain *const chain = _chains[signum].exchange(nullptr);
+    if (chain != nullptr)
+    {
+        for (std::size_t index = 0; index < chain->size; index++)
+        {
+            retire(chain->links[index].entry);
+        }
+        retire(chain);
+    }
+    reclaim();
+}
+
+#ifndef _WIN32
+std::uint64_t sigfn::internal::dispatch_table::claim(int signum, handler_entry *entry, int flags)
+{
+    std::unique_ptr<handler_entry> owned(entry);
+    if (signum <= 0 || signum >= signal_count)
+    {
+        throw error(invalid_signum);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    claim_record record = {entry, nullptr, {}};
+    if (sigaction(signum, nullptr, &record.previous) != 0)
+    {
+        throw error(invalid_syscall);
+    }
+    const std::uint64_t token = (++_serial << 8) | static_cast<std::uint64_t>(signum);
+    _claims.emplace(token, record);
+    try
+    {
+        state::attach(signum, flags);
+    }
+    catch (...)
+    {
+        _claims.erase(token);
+        throw;
+    }
+    _claims[token].replaced = _slots[signum].exchange(owned.release());
+    return token;
+}
+
+bool sigfn::internal::dispatch_table::unclaim(std::uint64_t token)
+{
+    const int signum = static_cast<int>(token & 0xff);
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::unordered_map<std::uint64_t, claim_record>::iterator found = _claims.find(token);
+    if (found == _claims.end())
+    {
+        return false;
+    }
+    const claim_record record = found->second;
+    _claims.erase(found);
+    if (_slots[signum].load() == record.entry)
+    {
+        _slots[signum].store(record.replaced);
+        retire(record.entry);
+        const bool default_action = ((record.previous.sa_flags & SA_SIGINFO) == 0 && record.previous.sa_handler == SIG_DFL);
+        if (!default_action)
+        {
+            sigaction(signum, &record.previous, nullptr);
+        }
+    }
+    else
+    {
+        // a later claim holds this entry as the one it replaced, so it
+        // inherits what this claim replaced instead
+        bool inherited(false);
+        for (std::pair<const std::uint64_t, claim_record> &claim : _claims)
+        {
+            if (claim.second.replaced == record.entry)
+            {
+                claim.second.replaced = record.replaced;
+                claim.second.previous = record.previous;
+                inherited = true;
+            }
+        }
+        // otherwise a store or clear already retired this claim's entry
+        retire(inherited ? record.entry : record.replaced);
+    }
+    reclaim();
+    return true;
+}
+#endif
+
+void sigfn::internal::dispatch_table::deliver(int signum, const siginfo_t *info)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        const rate_limiter::verdict verdict = state::limits.admit(signum);
+        if (verdict == rate_limiter::verdict::admitted)
+        {
+            forward(signum, info);
+        }
+        else
+        {
+            trace_delivery(signum, info);
+            if (verdict == rate_limiter::verdict::held)
+            {
+                state::deferred_dispatcher.notify(signum);
+            }
+            else
+            {
+                state::statistics.suppressed(signum);
+            }
+        }
+    }
+}
+
+void sigfn::internal::dispatch_table::forward(int signum, const siginfo_t *info)
+{
+    const reader_guard guard(_epoch, _readers);
+    handler_entry *const entry = _slots[signum].load();
+    const handler_chain *const chain = _chains[signum].load();
+    if (chain != nullptr)
+    {
+        for (std::size_t index = 0; index < chain->size; index++)
+        {
+            const handler_entry *const link = chain->links[index].entry;
+            if (link->mode == dispatch_mode::immediate)
+            {
+                const invocation_timer timer(signum, info, true);
+                link->invoke(signum, info);
+            }
+        }
+        if (chain->deferred)
+        {
+            // every deferred link shares a single dispatcher run
+            trace_delivery(signum, info);
+            if (_chain_pending[signum].exchange(true))
+            {
+                state::statistics.coalesced(signum);
+            }
+            else
+            {
+                state::deferred_dispatcher.notify(signum);
+            }
+        }
+    }
+    if ((entry == nullptr && chain == nullptr) || (entry != nullptr && entry->mode != dispatch_mode::immediate))
+    {
+        trace_delivery(signum, info);
+    }
+    if (entry == nullptr)
+    {
+        if (chain == nullptr)
+        {
+            state::statistics.dropped(signum);
+        }
+    }
+    else if (entry->mode == dispatch_mode::polled)
+    {
+        state::watched.set(signum);
+    }
+    else if (entry->mode == dispatch_mode::deferred)
+    {
+        if (!state::deferred_dispatcher.notify(signum))
+        {
+            state::statistics.coalesced(signum);
+        }
+    }
+    else if (entry->mode == dispatch_mode::coalesced)
+    {
+        // only the first delivery of a batch and the one reaching the
+        // threshold need to wake the dispatcher
+        const std::uint64_t count = entry->count.fetch_add(1) + 1;
+        if (count > 1)
+        {
+            state::statistics.coalesced(signum);
+        }
+        if (count == 1 || count == entry->threshold)
+        {
+            state::deferred_dispatcher.notify(signum);
+        }
+    }
+    else
+    {
+        const invocation_timer timer(signum, info, true);
+        entry->invoke(signum, info);
+    }
+}
+
+std::optional<std::chrono::steady_clock::time_point> sigfn::internal::dispatch_table::dispatch(int signum, const std::chrono::steady_clock::time_point &armed)
+{
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (signum > 0 && signum < signal_count)
+    {
+        std::optional<std::chrono::nanoseconds> remaining;
+        if (state::limits.release(signum, remaining))
+        {
+            // trailing edge of a debounce
+            forward(signum, nullptr);
+        }
+        else if (remaining.has_value())
+        {
+            deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining.value());
+        }
+        else
+        {
+            const reader_guard guard(_epoch, _readers);
+            handler_entry *const entry = _slots[signum].load();
+            const handler_chain *const chain = _chains[signum].load();
+            if (chain != nullptr && _chain_pending[signum].exchange(false))
+            {
+                for (std::size_t index = 0; index < chain->size; index++)
+                {
+                    const handler_entry *const link = chain->links[index].entry;
+                    if (link->mode == dispatch_mode::deferred)
+                    {
+                        try
+                        {
+                            const invocation_timer timer(signum, nullptr, false);
+                            link->invoke(signum, nullptr);
+                        }
+                        catch (...)
+                        {
+                            // attached handlers are independent, one throwing must not skip the rest
+                        }
+                    }
+                }
+            }
+            if (entry != nullptr && entry->mode == dispatch_mode::deferred && entry->pool != nullptr)
+            {
+                entry->pool->schedule(signum, entry->level);
+            }
+            else if (entry != nullptr && entry->mode == dispatch_mode::deferred)
+            {
+                const invocation_timer timer(signum, nullptr, false);
+                entry->invoke(signum, nullptr);
+            }
+            else if (entry != nullptr && entry->mode == dispatch_mode::coalesced)
+            {
+                const std::uint64_t pending = entry->count.load();
+                if (pending > 0)
+                {
+                    if ((std::chrono::steady_clock::now() - armed) >= entry->window ||
+                        (entry->threshold > 0 && pending >= entry->threshold))
+                    {
+                        const invocation_timer timer(signum, nullptr, false);
+                        entry->batch_function(signum, entry->count.exchange(0));
+                    }
+                    else
+                    {
+                        deadline = armed + entry->window;
+                    }
+                }
+            }
+        }
+    }
+    return deadline;
+}
+
+void sigfn::internal::dispatch_table::run(int signum, const worker_pool *pool)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        const reader_guard guard(_epoch, _readers);
+        handler_entry *const entry = _slots[signum].load();
+        if (entry != nullptr && entry->pool == pool)
+        {
+            const invocation_timer timer(signum, nullptr, false);
+            entry->invoke(signum, nullptr);
+        }
+    }
+}
+
+void sigfn::internal::dispatch_table::release(const worker_pool *pool)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int signum = 1; signum < signal_count; signum++)
+    {
+        handler_entry *const entry = _slots[signum].load();
+        if (entry != nullptr && entry->pool == pool)
+        {
+            // restored under the writer lock so a concurrent registration wins
+            if (_chains[signum].load() == nullptr)
+            {
+                state::hook(signum, SIG_DFL);
+            }
+            _slots[signum].store(nullptr);
+            retire(entry);
+        }
+    }
+    reclaim();
+}
+
+void sigfn::internal::dispatch_table::discard(worker_pool *pool)
+{
+    if (reader_depth == 0)
+    {
+        synchronize();
+        delete pool;
+    }
+    else
+    {
+        // the reader of this thread holds the epoch back, so waiting would
+        // never return; the stopped pool is freed by a later reclaim instead
+        pool->stop();
+        std::lock_guard<std::mutex> lock(_mutex);
+        retire(pool);
+        reclaim();
+    }
+}
+
+void sigfn::internal::dispatch_table::synchronize()
+{
+    // two epoch advances guarantee that every reader present on entry has left
+    const std::uint64_t target = _epoch.load() + 2;
+    while (_epoch.load() < target)
+    {
+        collect();
+        std::this_thread::yield();
+    }
+}
+
+void sigfn::internal::dispatch_table::collect()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    reclaim();
+}
+
+void sigfn::internal::dispatch_table::reclaim()
+{
+    // An entry retired during epoch E may still be referenced by readers that
+    // entered at E, so it is only safe to free once the epoch reaches E + 2.
+    // Advancing from E to E + 1 requires that no reader from E - 1 remains,
+    // and those readers share a counter with E + 1. Never waits on readers,
+    // so a handler may re-register its own signal without deadlocking.
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        const std::uint64_t epoch = _epoch.load();
+        if (_readers[(epoch + 1) & 1].load() != 0)
+        {
+            break;
+        }
+        _epoch.store(epoch + 1);
+    }
+    const std::uint64_t epoch = _epoch.load();
+    sweep(_retired, epoch);
+    sweep(_retired_chains, epoch);
+    sweep(_retired_pools, epoch);
+}
+
+void sigfn::internal::dispatch_table::retire(handler_entry *entry)
+{
+    if (entry != nullptr)
+    {
+        entry->retired_epoch = _epoch.load();
+        entry->retired_next = _retired;
+        _retired = entry;
+    }
+}
+
+void sigfn::internal::dispatch_table::retire(handler_chain *chain)
+{
+    if (chain != nullptr)
+    {
+        chain->retired_epoch = _epoch.load();
+        chain->retired_next = _retired_chains;
+        _retired_chains = chain;
+    }
+}
+
+void sigfn::internal::dispatch_table::retire(worker_pool *pool)
+{
+    pool->retired_epoch = _epoch.load();
+    pool->retired_next = _retired_pools;
+    _retired_pools = pool;
+}
+
+void sigfn::internal::dispatch_table::invoke(int signum, const siginfo_t *info)
+{
+    if (signum > 0 && signum < signal_count)
+    {
+        const reader_guard guard(_epoch, _readers);
+        handler_entry *const entry = _slots[signum].load();
+        const handler_chain *const chain = _chains[signum].load();
+        for (std::size_t index = 0; chain != nullptr && index < chain->size; index++)
+        {
+            try
+            {
+                const invocation_timer timer(signum, info, true);
+                chain->links[index].entry->invoke(signum, info);
+            }
+            catch (...)
+            {
+                // attached handlers are independent, one throwing must not skip the rest
+            }
+        }
+        if (entry != nullptr)
+        {
+            const invocation_timer timer(signum, info, true);
+            entry->invoke(signum, info);
+        }
+        else if (chain == nullptr)
+        {
+            state::statistics.dropped(signum);
+        }
+    }
+}
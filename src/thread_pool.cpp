@@ -0,0 +1,282 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+sigfn::internal::worker_pool::worker_pool(std::size_t workers)
+{
+    if (workers == 0)
+    {
+        throw error(invalid_capacity);
+    }
+    _workers.reserve(workers);
+    for (std::size_t index = 0; index < workers; index++)
+    {
+        _workers.push_back(std::make_unique<worker>());
+    }
+#ifndef _WIN32
+    // like the dispatcher, workers never steal signals from waiting threads
+    sigset_t blocked;
+    sigset_t previous;
+    sigfillset(&blocked);
+    pthread_sigmask(SIG_SETMASK, &blocked, &previous);
+#endif
+    try
+    {
+        for (std::size_t index = 0; index < workers; index++)
+        {
+            _workers[index]->thread = std::thread(&worker_pool::run, this, index);
+        }
+    }
+    catch (...)
+    {
+#ifndef _WIN32
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+#endif
+        stop();
+        throw;
+    }
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+#endif
+}
+
+sigfn::internal::worker_pool::~worker_pool()
+{
+    stop();
+}
+
+void sigfn::internal::worker_pool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    for (std::unique_ptr<worker> &worker : _workers)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+}
+
+void sigfn::internal::worker_pool::post(std::function<void()> task, sigfn::priority level)
+{
+    worker &target = *_workers[_next.fetch_add(1) % _workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.queues[static_cast<std::size_t>(level)].push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queued++;
+    }
+    _ready.notify_one();
+}
+
+void sigfn::internal::worker_pool::schedule(int signum, sigfn::priority level)
+{
+    int current = _signals[signum].load();
+    for (;;)
+    {
+        if (current == idle)
+        {
+            if (_signals[signum].compare_exchange_weak(current, scheduled))
+            {
+                enqueue(signum, level);
+                return;
+            }
+        }
+        else if (current == scheduled)
+        {
+            if (_signals[signum].compare_exchange_weak(current, rerun))
+            {
+                return;
+            }
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+void sigfn::internal::worker_pool::enqueue(int signum, sigfn::priority level)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        signal_queue &queue = _pending[static_cast<std::size_t>(level)];
+        queue.signums[(queue.head + queue.size) % signal_count] = signum;
+        queue.size++;
+        _queued++;
+    }
+    _ready.notify_one();
+}
+
+std::size_t sigfn::internal::worker_pool::size() const
+{
+    return _workers.size();
+}
+
+bool sigfn::internal::worker_pool::take(std::size_t self, std::function<void()> &task, int &signum, sigfn::priority &level)
+{
+    // every worker is searched for higher priority work before lower priority
+    // work is considered, starting with the signals and the worker's own deque
+    for (std::size_t index = 0; index < priority_count; index++)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            signal_queue &pending = _pending[index];
+            if (pending.size > 0)
+            {
+                signum = pending.signums[pending.head];
+                level = static_cast<sigfn::priority>(index);
+                pending.head = (pending.head + 1) % signal_count;
+                pending.size--;
+                return true;
+            }
+        }
+        for (std::size_t offset = 0; offset < _workers.size(); offset++)
+        {
+            worker &victim = *_workers[(self + offset) % _workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            std::deque<std::function<void()>> &queue = victim.queues[index];
+            if (!queue.empty())
+            {
+                if (offset == 0)
+                {
+                    task = std::move(queue.back());
+                    queue.pop_back();
+                }
+                else
+                {
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void sigfn::internal::worker_pool::run(std::size_t self)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(
+                lock,
+                [this]()
+                {
+                    return _queued > 0 || _stopping;
+                });
+            // queued work is drained before the workers exit
+            if (_queued == 0)
+            {
+                return;
+            }
+            _queued--;
+        }
+        // the reservation guarantees a task exists, though another worker may
+        // briefly hold the deque it sits in
+        std::function<void()> task;
+        int signum(0);
+        sigfn::priority level(sigfn::priority::normal);
+        while (!take(self, task, signum, level))
+        {
+            std::this_thread::yield();
+        }
+        if (signum != 0)
+        {
+            run_signal(signum, level);
+        }
+        else
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                // a throwing task must not take the worker down with it
+            }
+        }
+    }
+}
+
+void sigfn::internal::worker_pool::run_signal(int signum, sigfn::priority level)
+{
+    try
+    {
+        state::handler_table.run(signum, this);
+    }
+    catch (...)
+    {
+    }
+    int expected(scheduled);
+    if (!_signals[signum].compare_exchange_strong(expected, idle))
+    {
+        // delivered again while running, run once more
+        _signals[signum].store(scheduled);
+        enqueue(signum, level);
+    }
+}
+
+sigfn::thread_pool::thread_pool(std::size_t workers) : _pool(std::make_unique<internal::worker_pool>(workers))
+{
+}
+
+sigfn::thread_pool::~thread_pool()
+{
+    try
+    {
+        internal::state::handler_table.release(_pool.get());
+    }
+    catch (const std::exception &)
+    {
+    }
+    // no dispatcher may still be scheduling onto the pool once it is freed
+    internal::state::handler_table.discard(_pool.release());
+}
+
+void sigfn::thread_pool::post(std::function<void()> task, priority level)
+{
+    if (!task)
+    {
+        throw internal::error(internal::invalid_handler);
+    }
+    _pool->post(std::move(task), level);
+}
+
+std::size_t sigfn::thread_pool::size() const
+{
+    return _pool->size();
+}
+
+void sigfn::thread_pool::operator()(std::function<void()> task)
+{
+    post(std::move(task), priority::normal);
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "internal.hpp"
+
+#ifndef _WIN32
+sigfn::internal::timer_engine::timer_engine(int signum, std::chrono::nanoseconds tick) : _tick(tick)
+{
+#ifdef SIGFN_POSIX_TIMERS
+    if (signum < SIGRTMIN || signum > SIGRTMAX)
+    {
+        throw error(invalid_realtime);
+    }
+    if (tick.count() <= 0)
+    {
+        throw error(invalid_timer);
+    }
+    struct sigevent event = {};
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = signum;
+    if (timer_create(CLOCK_MONOTONIC, &event, &_timer) == -1)
+    {
+        throw error(invalid_timer);
+    }
+    _created = true;
+#else
+    static_cast<void>(signum);
+    throw error(unsupported);
+#endif
+}
+
+sigfn::internal::timer_engine::~timer_engine()
+{
+    close();
+}
+
+void sigfn::internal::timer_engine::expired()
+{
+#ifdef SIGFN_POSIX_TIMERS
+    // expirations while the previous signal was still queued are only
+    // reported as overruns of the one delivered
+    const int overruns = timer_getoverrun(_timer);
+    _ticks.fetch_add(1 + static_cast<std::uint64_t>(std::max(overruns, 0)), std::memory_order_release);
+#endif
+}
+
+void sigfn::internal::timer_engine::advance()
+{
+    std::vector<firing> fired;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        expire(_ticks.load(std::memory_order_acquire), fired);
+        if (_timers.empty())
+        {
+            arm(false);
+        }
+    }
+    for (const firing &timer : fired)
+    {
+        try
+        {
+            (*timer.callback)(timer.id, timer.overruns);
+        }
+        catch (...)
+        {
+            // timers are independent, one throwing callback must not skip the rest
+        }
+    }
+}
+
+sigfn::timer_id sigfn::internal::timer_engine::schedule(std::chrono::nanoseconds after, std::chrono::nanoseconds period, sigfn::timer_wheel::timer_function callback)
+{
+    if (!callback)
+    {
+        throw error(invalid_handler);
+    }
+    if (after.count() < 0 || period.count() < 0)
+    {
+        throw error(invalid_timer);
+    }
+    const std::lock_guard<std::mutex> lock(_mutex);
+    // relative to the kernel count, which may be ahead of the wheel
+    const std::uint64_t expiry = _ticks.load(std::memory_order_acquire) + ticks(after);
+    const sigfn::timer_id id = ++_serial;
+    _timers.emplace(id, timer{expiry, (period.count() > 0) ? ticks(period) : 0, std::make_shared<sigfn::timer_wheel::timer_function>(std::move(callback))});
+    insert(id, expiry);
+    try
+    {
+        arm(true);
+    }
+    catch (...)
+    {
+        _timers.erase(id);
+        throw;
+    }
+    return id;
+}
+
+bool sigfn::internal::timer_engine::cancel(sigfn::timer_id id)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    // the slot keeps the id until the wheel reaches it, where it is skipped
+    const bool cancelled = (_timers.erase(id) > 0);
+    if (_timers.empty())
+    {
+        arm(false);
+    }
+    return cancelled;
+}
+
+std::size_t sigfn::internal::timer_engine::size() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _timers.size();
+}
+
+void sigfn::internal::timer_engine::close()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+#ifdef SIGFN_POSIX_TIMERS
+    if (_created)
+    {
+        timer_delete(_timer);
+        _created = false;
+        _armed = false;
+    }
+#endif
+}
+
+std::uint64_t sigfn::internal::timer_engine::ticks(std::chrono::nanoseconds duration) const
+{
+    const std::uint64_t count = static_cast<std::uint64_t>((duration.count() + _tick.count() - 1) / _tick.count());
+    return std::max<std::uint64_t>(count, 1);
+}
+
+void sigfn::internal::timer_engine::insert(sigfn::timer_id id, std::uint64_t expiry)
+{
+    // a timer that is already due goes in the slot about to be expired
+    const std::uint64_t at = std::max(expiry, _current);
+    const std::uint64_t delta = at - _current;
+    std::size_t level(0);
+    while (level + 1 < level_count && delta >= (std::uint64_t(1) << (level_bits * (level + 1))))
+    {
+        level++;
+    }
+    _slots[level][(at >> (level_bits * level)) & (level_slots - 1)].push_back(id);
+}
+
+void sigfn::internal::timer_engine::cascade(std::size_t level)
+{
+    std::vector<sigfn::timer_id> moved;
+    moved.swap(_slots[level][(_current >> (level_bits * level)) & (level_slots - 1)]);
+    for (const sigfn::timer_id id : moved)
+    {
+        const std::unordered_map<sigfn::timer_id, timer>::iterator found = _timers.find(id);
+        if (found != _timers.end())
+        {
+            insert(id, found->second.expiry);
+        }
+    }
+}
+
+void sigfn::internal::timer_engine::expire(std::uint64_t target, std::vector<firing> &fired)
+{
+    while (_current < target)
+    {
+        _current++;
+        // cascade from the highest level that wrapped, so its timers can
+        // still land in the levels cascaded after it
+        std::size_t top(0);
+        while (top + 1 < level_count && (_current & ((std::uint64_t(1) << (level_bits * (top + 1))) - 1)) == 0)
+        {
+            top++;
+        }
+        for (std::size_t level = top; level > 0; level--)
+        {
+            cascade(level);
+        }
+        std::vector<sigfn::timer_id> due;
+        due.swap(_slots[0][_current & (level_slots - 1)]);
+        for (const sigfn::timer_id id : due)
+        {
+            const std::unordered_map<sigfn::timer_id, timer>::iterator found = _timers.find(id);
+            if (found == _timers.end())
+            {
+                // cancelled
+            }
+            else if (found->second.expiry > _current)
+            {
+                // a top level timer that is more than one wheel turn away
+                insert(id, found->second.expiry);
+            }
+            else if (found->second.period == 0)
+            {
+                fired.push_back({id, 0, std::move(found->second.callback)});
+                _timers.erase(found);
+            }
+            else
+            {
+                // a periodic timer fires once per advance and reports the
+                // periods it missed while the wheel caught up
+                timer &periodic = found->second;
+                const std::uint64_t overruns = (target - periodic.expiry) / periodic.period;
+                periodic.expiry += periodic.period * (overruns + 1);
+                fired.push_back({id, overruns, periodic.callback});
+                insert(id, periodic.expiry);
+            }
+        }
+    }
+}
+
+void sigfn::internal::timer_engine::arm(bool armed)
+{
+#ifdef SIGFN_POSIX_TIMERS
+    if (_created && armed != _armed)
+    {
+        struct itimerspec spec = {};
+        if (armed)
+        {
+            spec.it_value.tv_sec = static_cast<time_t>(_tick.count() / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(_tick.count() % 1000000000);
+            spec.it_interval = spec.it_value;
+        }
+        if (timer_settime(_timer, 0, &spec, nullptr) == -1)
+        {
+            throw error(invalid_timer);
+        }
+        _armed = armed;
+    }
+#else
+    static_cast<void>(armed);
+#endif
+}
+
+sigfn::timer_wheel::timer_wheel(int signum, const std::chrono::steady_clock::duration &tick)
+    : _engine(std::make_shared<internal::timer_engine>(signum, std::chrono::duration_cast<std::chrono::nanoseconds>(tick)))
+{
+    const std::shared_ptr<internal::timer_engine> engine = _engine;
+    // counted in signal context, so coalesced deliveries do not lose ticks;
+    // claimed rather than attached, so destruction can keep a handler for a
+    // late expiry
+    _claim = internal::state::handler_table.claim(
+        signum,
+        new internal::handler_entry(sigfn::handler_function(
+            [engine](int)
+            {
+                engine->expired();
+            })),
+        sigfn::restart);
+    try
+    {
+        _token = sigfn::attach_deferred(
+            signum,
+            [engine](int)
+            {
+                engine->advance();
+            });
+    }
+    catch (...)
+    {
+        internal::state::handler_table.unclaim(_claim);
+        throw;
+    }
+}
+
+sigfn::timer_wheel::~timer_wheel()
+{
+    // An expiry already queued survives timer_delete. The claim still holds
+    // the slot while the deferred link goes, and unclaim then leaves an empty
+    // sigfn handler, or the previous one, instead of the default action.
+    _engine->close();
+    sigfn::detach(_token);
+    internal::state::handler_table.unclaim(_claim);
+}
+
+sigfn::timer_id sigfn::timer_wheel::schedule(const std::chrono::steady_clock::duration &after, timer_function callback, const std::chrono::steady_clock::duration &period)
+{
+    return _engine->schedule(std::chrono::duration_cast<std::chrono::nanoseconds>(after), std::chrono::duration_cast<std::chrono::nanoseconds>(period), std::move(callback));
+}
+
+bool sigfn::timer_wheel::cancel(timer_id id)
+{
+    return _engine->cancel(id);
+}
+
+std::size_t sigfn::timer_wheel::size() const
+{
+    return _engine->size();
+}
+#endif
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    // plain integer, so reading it in signal context never constructs anything
+    thread_local pid_t cached_thread_id(0);
+
+    // the only thread of a forked child inherits its parent's cached id
+    void forget_thread_id()
+    {
+        cached_thread_id = 0;
+    }
+
+    const int fork_handler = pthread_atfork(nullptr, nullptr, forget_thread_id);
+}
+
+pid_t sigfn::internal::thread_id()
+{
+    static_cast<void>(fork_handler);
+    if (cached_thread_id == 0)
+    {
+#ifdef __linux__
+        cached_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+        std::uint64_t id(0);
+        pthread_threadid_np(nullptr, &id);
+        cached_thread_id = static_cast<pid_t>(id);
+#else
+        cached_thread_id = getpid();
+#endif
+    }
+    return cached_thread_id;
+}
+
+bool sigfn::internal::thread_exited(pid_t tid)
+{
+    bool exited(false);
+#ifdef __linux__
+    const int saved_errno = errno;
+    exited = (syscall(SYS_tgkill, getpid(), tid, 0) == -1 && errno == ESRCH);
+    errno = saved_errno;
+#else
+    static_cast<void>(tid);
+#endif
+    return exited;
+}
+
+void sigfn::internal::fd_writer::append(const void *data, std::size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    for (std::size_t index = 0; index < size; index++)
+    {
+        if (_size == sizeof(_buffer))
+        {
+            flush();
+        }
+        _buffer[_size++] = bytes[index];
+    }
+}
+
+void sigfn::internal::fd_writer::text(const char *string)
+{
+    append(string, std::strlen(string));
+}
+
+void sigfn::internal::fd_writer::number(std::uint64_t value)
+{
+    char digits[20];
+    std::size_t count(0);
+    do
+    {
+        digits[count++] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+    while (count > 0)
+    {
+        append(&digits[--count], 1);
+    }
+}
+
+void sigfn::internal::fd_writer::hex(std::uint64_t value)
+{
+    static const char symbols[] = "0123456789abcdef";
+    char digits[16];
+    std::size_t count(0);
+    do
+    {
+        digits[count++] = symbols[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+    text("0x");
+    while (count > 0)
+    {
+        append(&digits[--count], 1);
+    }
+}
+
+void sigfn::internal::fd_writer::microseconds(std::uint64_t nanoseconds)
+{
+    const char fraction[4] = {
+        static_cast<char>('0' + (nanoseconds / 100) % 10),
+        static_cast<char>('0' + (nanoseconds / 10) % 10),
+        static_cast<char>('0' + nanoseconds % 10),
+        '\0'};
+    number(nanoseconds / 1000);
+    text(".");
+    text(fraction);
+}
+
+bool sigfn::internal::fd_writer::flush()
+{
+    std::size_t written(0);
+    while (!_failed && written < _size)
+    {
+        const ssize_t result = write(_fd, _buffer + written, _size - written);
+        if (result > 0)
+        {
+            written += static_cast<std::size_t>(result);
+        }
+        else if (result < 0 && errno != EINTR)
+        {
+            _failed = true;
+        }
+    }
+    _size = 0;
+    return !_failed;
+}
+
+namespace
+{
+    void write_chrome(sigfn::internal::fd_writer &out, const sigfn_trace_event &event, pid_t pid, bool &first)
+    {
+        if (event.delivered_ns != 0)
+        {
+            out.text(first ? "\n" : ",\n");
+            out.text("{\"name\":\"signal ");
+            out.number(static_cast<std::uint64_t>(event.signum));
+            out.text("\",\"cat\":\"sigfn\",\"ph\":\"i\",\"s\":\"t\",\"pid\":");
+            out.number(static_cast<std::uint64_t>(pid));
+            out.text(",\"tid\":");
+            out.number(static_cast<std::uint64_t>(event.tid));
+            out.text(",\"ts\":");
+            out.microseconds(event.delivered_ns);
+            out.text(",\"args\":{\"sender\":");
+            out.number(static_cast<std::uint64_t>(event.sender));
+            out.text("}}");
+            first = false;
+        }
+        if (event.entered_ns != 0)
+        {
+            out.text(first ? "\n" : ",\n");
+            out.text("{\"name\":\"handler ");
+            out.number(static_cast<std::uint64_t>(event.signum));
+            out.text("\",\"cat\":\"sigfn\",\"ph\":\"X\",\"pid\":");
+            out.number(static_cast<std::uint64_t>(pid));
+            out.text(",\"tid\":");
+            out.number(static_cast<std::uint64_t>(event.tid));
+            out.text(",\"ts\":");
+            out.microseconds(event.entered_ns);
+            out.text(",\"dur\":");
+            out.microseconds(event.exited_ns - event.entered_ns);
+            out.text("}");
+            first = false;
+        }
+    }
+}
+
+void sigfn::internal::trace_buffer::start(std::size_t threads, std::size_t capacity)
+{
+    if (threads == 0 || capacity == 0)
+    {
+        throw error(invalid_capacity);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_rings.load() == nullptr)
+    {
+        std::size_t size(1);
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        std::unique_ptr<ring[]> rings(new ring[threads]);
+        try
+        {
+            for (std::size_t index = 0; index < threads; index++)
+            {
+                rings[index].events = new event[size];
+            }
+        }
+        catch (...)
+        {
+            for (std::size_t index = 0; index < threads; index++)
+            {
+                delete[] rings[index].events;
+            }
+            throw;
+        }
+        _threads = threads;
+        _capacity = size;
+        _rings.store(rings.release(), std::memory_order_release);
+    }
+    _enabled.store(true, std::memory_order_release);
+}
+
+void sigfn::internal::trace_buffer::stop()
+{
+    _enabled.store(false, std::memory_order_release);
+}
+
+sigfn::internal::trace_buffer::ring *sigfn::internal::trace_buffer::claim(pid_t tid)
+{
+    ring *const rings = _rings.load(std::memory_order_acquire);
+    ring *claimed(nullptr);
+    if (rings != nullptr)
+    {
+        for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+        {
+            if (rings[index].owner.load(std::memory_order_relaxed) == tid)
+            {
+                claimed = &rings[index];
+            }
+        }
+        for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+        {
+            pid_t expected(0);
+            if (rings[index].owner.compare_exchange_strong(expected, tid) || expected == tid)
+            {
+                claimed = &rings[index];
+            }
+        }
+        // Once every ring is owned, take over one whose thread exited. The
+        // ring is not released at thread exit because registering a
+        // thread_local destructor on the first record, in signal context,
+        // may allocate. Its events stay readable until they are overwritten.
+        for (std::size_t index = 0; claimed == nullptr && index < _threads; index++)
+        {
+            pid_t owner = rings[index].owner.load(std::memory_order_relaxed);
+            if (owner != tid && thread_exited(owner) && rings[index].owner.compare_exchange_strong(owner, tid))
+            {
+                claimed = &rings[index];
+            }
+        }
+    }
+    return claimed;
+}
+
+void sigfn::internal::trace_buffer::record(int signum, pid_t sender, std::uint64_t delivered, std::uint64_t entered, std::uint64_t exited)
+{
+    const pid_t tid = thread_id();
+    ring *const target = claim(tid);
+    if (target == nullptr)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const std::uint64_t position = target->head.fetch_add(1, std::memory_order_relaxed);
+    event &slot = target->events[position & (_capacity - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.signum.store(signum, std::memory_order_relaxed);
+    slot.tid.store(tid, std::memory_order_relaxed);
+    slot.sender.store(sender, std::memory_order_relaxed);
+    slot.delivered.store(delivered, std::memory_order_relaxed);
+    slot.entered.store(entered, std::memory_order_relaxed);
+    slot.exited.store(exited, std::memory_order_relaxed);
+    slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+bool sigfn::internal::trace_buffer::dump(int fd, trace_format format) const
+{
+    fd_writer out(fd);
+    const ring *const rings = _rings.load(std::memory_order_acquire);
+    const pid_t pid = getpid();
+    bool first(true);
+    if (format == trace_format::binary)
+    {
+        sigfn_trace_header header = {{'S', 'I', 'G', 'F', 'N', 'T', 'R', 'C'}, 1, sizeof(sigfn_trace_event), _dropped.load(std::memory_order_relaxed)};
+        out.append(&header, sizeof(header));
+    }
+    else
+    {
+        out.text("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    }
+    for (std::size_t index = 0; rings != nullptr && index < _threads; index++)
+    {
+        const ring &source = rings[index];
+        if (source.owner.load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+        const std::uint64_t head = source.head.load(std::memory_order_acquire);
+        for (std::uint64_t position = (head > _capacity) ? head - _capacity : 0; position < head; position++)
+        {
+            const event &slot = source.events[position & (_capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                continue;
+            }
+            const sigfn_trace_event event = {
+                slot.signum.load(std::memory_order_relaxed),
+                slot.tid.load(std::memory_order_relaxed),
+                slot.sender.load(std::memory_order_relaxed),
+                0,
+                slot.delivered.load(std::memory_order_relaxed),
+                slot.entered.load(std::memory_order_relaxed),
+                slot.exited.load(std::memory_order_relaxed)};
+            // discard slots overwritten while they were being copied
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != position + 1)
+            {
+                continue;
+            }
+            if (format == trace_format::binary)
+            {
+                out.append(&event, sizeof(event));
+            }
+            else
+            {
+                write_chrome(out, event, pid, first);
+            }
+        }
+    }
+    if (format == trace_format::chrome)
+    {
+        out.text("\n],\"otherData\":{\"dropped\":");
+        out.number(_dropped.load(std::memory_order_relaxed));
+        out.text("}}\n");
+    }
+    return out.flush();
+}
+
+void sigfn::trace_start(std::size_t threads, std::size_t capacity)
+{
+    internal::state::tracer.start(threads, capacity);
+}
+
+void sigfn::trace_stop()
+{
+    internal::state::tracer.stop();
+}
+
+void sigfn::trace_dump(int fd, trace_format format)
+{
+    if (format != trace_format::binary && format != trace_format::chrome)
+    {
+        throw internal::error(internal::invalid_format);
+    }
+    if (!internal::state::tracer.dump(fd, format))
+    {
+        throw internal::error(internal::invalid_trace);
+    }
+}
+
+sigfn::handler_token sigfn::trace_dump_on(int signum, int fd, trace_format format)
+{
+    if (format != trace_format::binary && format != trace_format::chrome)
+    {
+        throw internal::error(internal::invalid_format);
+    }
+    return sigfn::attach(
+        signum,
+        [fd, format](int)
+        {
+            internal::state::tracer.dump(fd, format);
+        });
+}
+#endif
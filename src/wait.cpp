@@ -0,0 +1,210 @@
+/*
+ * Copyright 2025 Maxtek Consulting
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "internal.hpp"
+
+#ifdef SIGFN_SIGTIMEDWAIT
+#include <cerrno>
+#include <ctime>
+
+namespace
+{
+    void discard(int signum)
+    {
+        static_cast<void>(signum);
+    }
+
+    // Blocks a signal set in the calling thread for the lifetime of a wait.
+    // Ignored signals may be discarded at generation, so their disposition
+    // is swapped for a handler that never runs while the set is blocked.
+    class blocked_sigset
+    {
+    public:
+        explicit blocked_sigset(const sigset_t &sigset) : _sigset(sigset)
+        {
+            sigemptyset(&_replaced);
+            if (pthread_sigmask(SIG_BLOCK, &_sigset, &_previous_mask) != 0)
+            {
+                throw sigfn::internal::error(sigfn::internal::invalid_wait);
+            }
+            for (int signum = 1; signum < sigfn::internal::signal_count; signum++)
+            {
+                if (sigismember(&_sigset, signum) == 1 &&
+                    sigaction(signum, nullptr, &_previous[signum]) == 0 &&
+                    _previous[signum].sa_handler == SIG_IGN)
+                {
+                    struct sigaction action = {};
+                    action.sa_handler = discard;
+                    sigemptyset(&action.sa_mask);
+                    if (sigaction(signum, &action, nullptr) == 0)
+                    {
+                        sigaddset(&_replaced, signum);
+                    }
+                }
+            }
+        }
+
+        blocked_sigset(const blocked_sigset &) = delete;
+        blocked_sigset &operator=(const blocked_sigset &) = delete;
+
+        ~blocked_sigset()
+        {
+            for (int signum = 1; signum < sigfn::internal::signal_count; signum++)
+            {
+                if (sigismember(&_replaced, signum) == 1)
+                {
+                    sigaction(signum, &_previous[signum], nullptr);
+                }
+            }
+            pthread_sigmask(SIG_SETMASK, &_previous_mask, nullptr);
+        }
+
+        const sigset_t &sigset() const
+        {
+            return _sigset;
+        }
+
+    private:
+        sigset_t _sigset;
+        sigset_t _previous_mask;
+        sigset_t _replaced;
+        std::array<struct sigaction, sigfn::internal::signal_count> _previous;
+    };
+
+    template <class Clock>
+    bool wait_deadline(const sigset_t &sigset, int &signum, const typename Clock::time_point &deadline)
+    {
+        const blocked_sigset blocked(sigset);
+        int result;
+        do
+        {
+            const typename Clock::duration remaining = std::max(deadline - Clock::now(), Clock::duration::zero());
+            const std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+            struct timespec timeout;
+            timeout.tv_sec = static_cast<time_t>(seconds.count());
+            timeout.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - seconds).count());
+            result = sigtimedwait(&blocked.sigset(), nullptr, &timeout);
+        } while (result < 0 && errno == EINTR);
+        if (result < 0 && errno != EAGAIN)
+        {
+            throw sigfn::internal::error(sigfn::internal::invalid_wait);
+        }
+        if (result > 0)
+        {
+            signum = result;
+        }
+        return result > 0;
+    }
+}
+
+void sigfn::internal::wait_sigset(const sigset_t &sigset, int &signum)
+{
+    const blocked_sigset blocked(sigset);
+    int result;
+    do
+    {
+        result = sigwaitinfo(&blocked.sigset(), nullptr);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0)
+    {
+        throw error(invalid_wait);
+    }
+    signum = result;
+}
+
+bool sigfn::internal::wait_sigset(const sigset_t &sigset, int &signum, const std::chrono::steady_clock::time_point &deadline)
+{
+    return wait_deadline<std::chrono::steady_clock>(sigset, signum, deadline);
+}
+
+bool sigfn::internal::wait_sigset(const sigset_t &sigset, int &signum, const std::chrono::system_clock::time_point &deadline)
+{
+    return wait_deadline<std::chrono::system_clock>(sigset, signum, deadline);
+}
+
+bool sigfn::internal::wait_stoppable(const int *signums, std::size_t count, int &signum, const sigfn::stop_token &token)
+{
+    sigset_t sigset = make_sigset(signums, signums + count);
+    if (token._state == nullptr)
+    {
+        wait_sigset(sigset, signum);
+        return true;
+    }
+    stop_state &state = *token._state;
+    for (const int stop : state.signums)
+    {
+        sigaddset(&sigset, stop);
+    }
+    sigset_t stops;
+    sigemptyset(&stops);
+    for (const int stop : state.signums)
+    {
+        sigaddset(&stops, stop);
+    }
+    int result(-1);
+    {
+        const blocked_sigset blocked(sigset);
+        if (state.enter(pthread_self()))
+        {
+            do
+            {
+                result = sigwaitinfo(&blocked.sigset(), nullptr);
+            } while (result < 0 && errno == EINTR);
+            state.leave(pthread_self());
+            if (result < 0)
+            {
+                throw error(invalid_wait);
+            }
+            if (sigismember(&stops, result) == 1)
+            {
+                // the wait consumed the signal before the stop handler saw it
+                state.request();
+                result = -1;
+            }
+        }
+        if (state.requested.load())
+        {
+            // The stop may have signalled this thread after the wait returned.
+            // Consume that signal while the set is still blocked, since it
+            // only repeats the stop.
+            const struct timespec immediate = {0, 0};
+            while (sigtimedwait(&stops, nullptr, &immediate) > 0)
+            {
+            }
+        }
+    }
+    if (result > 0)
+    {
+        signum = result;
+    }
+    return result > 0;
+}
+#else
+bool sigfn::internal::wait_stoppable(const int *signums, std::size_t count, int &signum, const sigfn::stop_token &token)
+{
+    static_cast<void>(signums);
+    static_cast<void>(count);
+    static_cast<void>(signum);
+    static_cast<void>(token);
+    throw error(unsupported);
+}
+#endif
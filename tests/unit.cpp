@@ -23,6 +23,9 @@
 #include <maxtest.hpp>
 #include "internal.hpp"
 
+#include <condition_variable>
+#include <cstdlib>
+
 #define PASS 0
 #define FAIL 1
 
@@ -30,6 +33,10 @@
 #define INVALID_HANDLER nullptr
 
 #ifndef _WIN32 // WINDOWS
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 #include <unistd.h>
 template <class Period, class Rep>
 static void signal_from_child(int signum, const std::chrono::duration<Rep, Period> &duration)
@@ -42,10 +49,301 @@ static void signal_from_child(int signum, const std::chrono::duration<Rep, Perio
         _exit(0);
     }
 }
+
+template <class Period, class Rep>
+static pid_t spawn_child(int status, const std::chrono::duration<Rep, Period> &duration)
+{
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        std::this_thread::sleep_for(duration);
+        _exit(status);
+    }
+    return pid;
+}
+
+// runs crash in a child without core dumps, returns what it wrote to the
+// descriptor it was given and stores its wait status
+static std::string crash_child(const std::function<void(int)> &crash, int &status)
+{
+    std::string report;
+    int fds[2];
+    if (pipe(fds) == 0)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            const struct rlimit limit = {0, 0};
+            setrlimit(RLIMIT_CORE, &limit);
+            close(fds[0]);
+            crash(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        char buffer[256];
+        ssize_t size;
+        while ((size = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            report.append(buffer, static_cast<std::size_t>(size));
+        }
+        close(fds[0]);
+        waitpid(pid, &status, 0);
+    }
+    return report;
+}
+
+// recurses until the stack overflows
+static int overflow_stack(int depth)
+{
+    volatile char frame[1024];
+    frame[depth % sizeof(frame)] = static_cast<char>(depth);
+    return overflow_stack(depth + 1) + frame[0];
+}
+
+static void exit_chained(int signum)
+{
+    static_cast<void>(signum);
+    _exit(42);
+}
+
+// page that faults until the previous SIGSEGV handler makes it writable
+static void *guarded_page(nullptr);
+
+static void unprotect_page(int signum, siginfo_t *info, void *context)
+{
+    static_cast<void>(signum);
+    static_cast<void>(context);
+    if (info->si_addr != guarded_page || mprotect(guarded_page, 4096, PROT_READ | PROT_WRITE) != 0)
+    {
+        _exit(43);
+    }
+}
+
+// burns CPU time on the calling thread
+static void spin_for(const std::chrono::steady_clock::duration &duration)
+{
+    volatile std::uint64_t sum(0);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (std::uint64_t index = 0; index < 1000; index++)
+        {
+            sum = sum + index;
+        }
+    }
+}
+
+// returns what dump wrote to a temporary file
+static std::string dump_file(const std::function<void(int)> &dump)
+{
+    std::string contents;
+    FILE *const file = std::tmpfile();
+    if (file != nullptr)
+    {
+        dump(fileno(file));
+        std::rewind(file);
+        char buffer[256];
+        std::size_t size;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.append(buffer, size);
+        }
+        std::fclose(file);
+    }
+    return contents;
+}
+
+// sums the counts of folded stack lines, 0 if a line is malformed
+static std::uint64_t folded_samples(const std::string &folded)
+{
+    std::uint64_t total(0);
+    bool valid(!folded.empty());
+    std::size_t start(0);
+    while (valid && start < folded.size())
+    {
+        const std::size_t end = folded.find('\n', start);
+        const std::size_t space = folded.rfind(' ', end);
+        valid = (end != std::string::npos && space != std::string::npos && space > start && space + 1 < end);
+        if (valid)
+        {
+            total += std::strtoull(folded.substr(space + 1, end - space - 1).c_str(), nullptr, 10);
+            start = end + 1;
+        }
+    }
+    return valid ? total : 0;
+}
+#endif
+
+#ifdef SIGFN_NO_HEAP
+// counts every allocation of the process, so a test can check that delivery does not allocate
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    void *const pointer = std::malloc((size == 0) ? 1 : size);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t size) noexcept
+{
+    static_cast<void>(size);
+    std::free(pointer);
+}
+#endif
+
+// static handler that notices being destroyed while it runs
+struct tracked_handler
+{
+    static inline std::atomic<const tracked_handler *> running{nullptr};
+    static inline std::atomic<bool> destroyed_while_running{false};
+
+    std::chrono::milliseconds delay;
+
+    ~tracked_handler()
+    {
+        if (running.load() == this)
+        {
+            destroyed_while_running = true;
+        }
+    }
+
+    void operator()() const
+    {
+        running = this;
+        std::this_thread::sleep_for(delay);
+        running = nullptr;
+    }
+};
+
+#if defined(SIGFN_COROUTINES) && defined(__cpp_impl_coroutine)
+// fire-and-forget coroutine, the test observes it through the awaited values
+struct detached_task
+{
+    struct promise_type
+    {
+        detached_task get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+// coroutine the test owns, so it can be destroyed while it is suspended
+struct owned_task
+{
+    struct promise_type
+    {
+        owned_task get_return_object() noexcept
+        {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <class Executor>
+static owned_task await_owned(int signum, Executor executor)
+{
+    co_await sigfn::async_wait(&signum, 1, executor);
+}
+
+template <class Executor>
+static detached_task await_signal(int signum, std::atomic<int> &resumed, Executor executor)
+{
+    const int received = co_await sigfn::async_wait(&signum, 1, executor);
+    if (received == signum)
+    {
+        resumed++;
+    }
+}
+
+template <class Rep, class Period>
+static detached_task await_timeout(int signum, std::chrono::duration<Rep, Period> timeout, std::promise<int> &promise)
+{
+    const std::optional<int> received = co_await sigfn::async_wait_for(&signum, 1, timeout);
+    promise.set_value(received.value_or(0));
+}
+
+static detached_task await_invalid(std::promise<bool> &promise)
+{
+    try
+    {
+        const int signum(INVALID_SIGNUM);
+        co_await sigfn::async_wait(&signum, 1);
+        promise.set_value(false);
+    }
+    catch (const std::exception &e)
+    {
+        promise.set_value(e.what() != nullptr);
+    }
+}
 #endif
 
 static void echo_signum(int signum, void *userdata);
 
+static void fulfill_signum(int signum, void *userdata);
+
+static void count_call(void *userdata);
+
+static void fulfill_count(int signum, uint64_t count, void *userdata);
+
+#ifndef _WIN32 // WINDOWS
+static void echo_info(const siginfo_t *info, void *userdata);
+
+static void record_exit(const sigfn_child_exit *exit, void *userdata);
+
+static void count_timer(sigfn_timer_id id, uint64_t overruns, void *userdata);
+#endif
+
 // GCOV_EXCL_START
 MAXTEST_MAIN
 {
@@ -60,6 +358,169 @@ MAXTEST_MAIN
         MAXTEST_ASSERT(flag == signum);
     };
 
+    MAXTEST_TEST_CASE(sigfn_handle_info)
+    {
+#ifndef _WIN32 // WINDOWS
+        siginfo_t received = {};
+        union sigval value;
+        MAXTEST_ASSERT(::sigfn_handle_info(SIGUSR1, NULL, &received, SIGFN_RESTART) == -1);
+        MAXTEST_ASSERT(::sigfn_handle_info(INVALID_SIGNUM, echo_info, &received, SIGFN_RESTART) == -1);
+        MAXTEST_ASSERT(::sigfn_handle_info(SIGUSR1, echo_info, &received, SIGFN_RESTART | SIGFN_NODEFER) == 0);
+        value.sival_int = 42;
+        MAXTEST_ASSERT(sigqueue(getpid(), SIGUSR1, value) == 0);
+        MAXTEST_ASSERT(received.si_signo == SIGUSR1);
+        MAXTEST_ASSERT(received.si_code == SI_QUEUE);
+        MAXTEST_ASSERT(received.si_pid == getpid());
+        MAXTEST_ASSERT(received.si_value.sival_int == 42);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_defer)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        MAXTEST_ASSERT(::sigfn_defer(SIGINT, INVALID_HANDLER, &promise) == -1);
+        MAXTEST_ASSERT(::sigfn_defer(INVALID_SIGNUM, fulfill_signum, &promise) == -1);
+        MAXTEST_ASSERT(::sigfn_defer(SIGINT, fulfill_signum, &promise) == 0);
+        raise(SIGINT);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == SIGINT);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_defer_pool)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_thread_pool *pool(nullptr);
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        MAXTEST_ASSERT(::sigfn_thread_pool_create(0, &pool) == -1);
+        MAXTEST_ASSERT(::sigfn_thread_pool_create(2, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_thread_pool_create(2, &pool) == PASS);
+        MAXTEST_ASSERT(::sigfn_defer_pool(SIGUSR1, fulfill_signum, &promise, nullptr, SIGFN_PRIORITY_HIGH) == -1);
+        MAXTEST_ASSERT(::sigfn_defer_pool(SIGUSR1, fulfill_signum, &promise, pool, 7) == -1);
+        MAXTEST_ASSERT(::sigfn_defer_pool(SIGUSR1, INVALID_HANDLER, &promise, pool, SIGFN_PRIORITY_HIGH) == -1);
+        MAXTEST_ASSERT(::sigfn_defer_pool(SIGUSR1, fulfill_signum, &promise, pool, SIGFN_PRIORITY_HIGH) == PASS);
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == SIGUSR1);
+        ::sigfn_thread_pool_destroy(pool);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_attach)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_token first(0);
+        sigfn_token second(0);
+        sigfn_token deferred(0);
+        int first_flag(INVALID_SIGNUM);
+        int second_flag(INVALID_SIGNUM);
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        MAXTEST_ASSERT(::sigfn_attach(SIGUSR2, INVALID_HANDLER, &first_flag, &first) == -1);
+        MAXTEST_ASSERT(::sigfn_attach(INVALID_SIGNUM, echo_signum, &first_flag, &first) == -1);
+        MAXTEST_ASSERT(::sigfn_attach(SIGUSR2, echo_signum, &first_flag, &first) == PASS);
+        MAXTEST_ASSERT(::sigfn_attach(SIGUSR2, echo_signum, &second_flag, &second) == PASS);
+        MAXTEST_ASSERT(::sigfn_attach_deferred(SIGUSR2, fulfill_signum, &promise, &deferred) == PASS);
+        MAXTEST_ASSERT(first != second);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(first_flag == SIGUSR2);
+        MAXTEST_ASSERT(second_flag == SIGUSR2);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == SIGUSR2);
+        MAXTEST_ASSERT(::sigfn_detach(first) == PASS);
+        MAXTEST_ASSERT(::sigfn_detach(first) == 1);
+        MAXTEST_ASSERT(::sigfn_detach(deferred) == PASS);
+        MAXTEST_ASSERT(::sigfn_detach(0) == -1);
+        first_flag = INVALID_SIGNUM;
+        second_flag = INVALID_SIGNUM;
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(first_flag == INVALID_SIGNUM);
+        MAXTEST_ASSERT(second_flag == SIGUSR2);
+        MAXTEST_ASSERT(::sigfn_detach(second) == PASS);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_coalesce)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::promise<uint64_t> promise;
+        std::future<uint64_t> future = promise.get_future();
+        struct timeval window;
+        window.tv_sec = 10;
+        window.tv_usec = 0;
+        MAXTEST_ASSERT(::sigfn_coalesce(SIGUSR1, NULL, &promise, &window, 16) == -1);
+        MAXTEST_ASSERT(::sigfn_coalesce(INVALID_SIGNUM, fulfill_count, &promise, &window, 16) == -1);
+        MAXTEST_ASSERT(::sigfn_coalesce(SIGUSR1, fulfill_count, &promise, &window, 16) == 0);
+        // the threshold flushes the batch long before the window elapses
+        for (int index = 0; index < 16; index++)
+        {
+            raise(SIGUSR1);
+        }
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == 16);
+        sigfn_reset(SIGUSR1);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_watch)
+    {
+        MAXTEST_ASSERT(::sigfn_watch(INVALID_SIGNUM) == -1);
+        MAXTEST_ASSERT(::sigfn_watch(SIGINT) == PASS);
+        static_cast<void>(::sigfn_poll());
+        MAXTEST_ASSERT(::sigfn_pending(SIGINT) == 0);
+        MAXTEST_ASSERT(::sigfn_pending(INVALID_SIGNUM) == 0);
+        raise(SIGINT);
+        MAXTEST_ASSERT(::sigfn_pending(SIGINT) == 1);
+        MAXTEST_ASSERT(::sigfn_pending(SIGINT) == 1);
+        MAXTEST_ASSERT((::sigfn_poll() & SIGFN_SIGNAL_BIT(SIGINT)) != 0);
+        MAXTEST_ASSERT(::sigfn_pending(SIGINT) == 0);
+        MAXTEST_ASSERT(::sigfn_poll() == 0);
+        MAXTEST_ASSERT(::sigfn_reset(SIGINT) == PASS);
+    };
+
+    MAXTEST_TEST_CASE(sigfn_rate_limit)
+    {
+        sigfn_signal_stats stats;
+        int flag(INVALID_SIGNUM);
+        struct timeval interval;
+        interval.tv_sec = 60;
+        interval.tv_usec = 0;
+        MAXTEST_ASSERT(::sigfn_rate_limit(INVALID_SIGNUM, 1.0, 1) == -1);
+        MAXTEST_ASSERT(::sigfn_rate_limit(SIGINT, 0.0, 1) == -1);
+        MAXTEST_ASSERT(::sigfn_rate_limit(SIGINT, 1e-300, 1) == -1);
+        MAXTEST_ASSERT(::sigfn_rate_limit(SIGINT, 1.0, 0) == -1);
+        MAXTEST_ASSERT(::sigfn_throttle(SIGINT, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_debounce(SIGINT, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_unlimit(INVALID_SIGNUM) == -1);
+        MAXTEST_ASSERT(::sigfn_stats_reset() == PASS);
+        MAXTEST_ASSERT(::sigfn_handle(SIGINT, echo_signum, &flag) == PASS);
+        // one token per minute with room for a burst of two
+        MAXTEST_ASSERT(::sigfn_rate_limit(SIGINT, 1.0 / 60.0, 2) == PASS);
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
+        flag = INVALID_SIGNUM;
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
+        flag = INVALID_SIGNUM;
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == INVALID_SIGNUM);
+        MAXTEST_ASSERT(::sigfn_throttle(SIGINT, &interval) == PASS);
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
+        flag = INVALID_SIGNUM;
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == INVALID_SIGNUM);
+        MAXTEST_ASSERT(::sigfn_stats(SIGINT, &stats) == PASS);
+        MAXTEST_ASSERT(stats.suppressed == 2);
+        MAXTEST_ASSERT(::sigfn_unlimit(SIGINT) == PASS);
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
+        MAXTEST_ASSERT(::sigfn_reset(SIGINT) == PASS);
+    };
+
     MAXTEST_TEST_CASE(sigfn_ignore)
     {
         MAXTEST_ASSERT(::sigfn_ignore(INVALID_SIGNUM) == -1);
@@ -173,6 +634,391 @@ MAXTEST_MAIN
 #endif
     };
 
+    MAXTEST_TEST_CASE(sigfn_stop_source)
+    {
+#ifndef _WIN32 // WINDOWS
+        const int stops[] = {SIGUSR2};
+        const int signums[] = {SIGUSR1};
+        sigfn_stop_source *source(nullptr);
+        int received(INVALID_SIGNUM);
+        MAXTEST_ASSERT(::sigfn_stop_source_create(stops, 0, &source) == -1);
+        MAXTEST_ASSERT(::sigfn_stop_source_create(stops, 1, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_stop_source_create(stops, 1, &source) == PASS);
+        MAXTEST_ASSERT(::sigfn_stop_requested(source) == 0);
+        MAXTEST_ASSERT(::sigfn_stop_requested(nullptr) == 0);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(::sigfn_stop_requested(source) == 1);
+        MAXTEST_ASSERT(::sigfn_stop_request(source) == 1);
+        MAXTEST_ASSERT(::sigfn_stop_request(nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_wait_stoppable(signums, 1, &received, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_wait_stoppable(signums, 1, &received, source) == 1);
+        MAXTEST_ASSERT(received == INVALID_SIGNUM);
+        ::sigfn_stop_source_destroy(source);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_shutdown)
+    {
+#ifndef _WIN32 // WINDOWS
+        const int signums[] = {SIGUSR2};
+        sigfn_shutdown *shutdown(nullptr);
+        sigfn_shutdown_timing timings[4];
+        size_t count(0);
+        std::atomic<int> escalations(0);
+        std::atomic<int> drained(0);
+        struct timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+        MAXTEST_ASSERT(::sigfn_shutdown_create(signums, 0, count_call, &escalations, &shutdown) == -1);
+        MAXTEST_ASSERT(::sigfn_shutdown_create(signums, 1, count_call, &escalations, nullptr) == -1);
+        MAXTEST_ASSERT(::sigfn_shutdown_create(signums, 1, count_call, &escalations, &shutdown) == PASS);
+        MAXTEST_ASSERT(::sigfn_shutdown_add(shutdown, "late", 2, &timeout, count_call, &drained) == PASS);
+        MAXTEST_ASSERT(::sigfn_shutdown_add(shutdown, "early", 1, &timeout, count_call, &drained) == PASS);
+        MAXTEST_ASSERT(::sigfn_shutdown_add(shutdown, "invalid", 1, &timeout, nullptr, &drained) == -1);
+        MAXTEST_ASSERT(::sigfn_shutdown_add(shutdown, "invalid", 1, nullptr, count_call, &drained) == -1);
+        MAXTEST_ASSERT(::sigfn_shutdown_wait(nullptr, timings, 4, &count) == -1);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(::sigfn_shutdown_wait(shutdown, timings, 4, &count) == PASS);
+        MAXTEST_ASSERT(count == 2);
+        MAXTEST_ASSERT(drained == 2);
+        MAXTEST_ASSERT(escalations == 0);
+        MAXTEST_ASSERT(std::strcmp(timings[0].name, "early") == 0);
+        MAXTEST_ASSERT(timings[0].stage == 1);
+        MAXTEST_ASSERT(timings[0].status == SIGFN_SHUTDOWN_COMPLETED);
+        MAXTEST_ASSERT(std::strcmp(timings[1].name, "late") == 0);
+        MAXTEST_ASSERT(timings[1].status == SIGFN_SHUTDOWN_COMPLETED);
+        // the stages only drain once
+        MAXTEST_ASSERT(::sigfn_shutdown_run(shutdown, timings, 1, &count) == PASS);
+        MAXTEST_ASSERT(count == 1);
+        MAXTEST_ASSERT(drained == 2);
+        ::sigfn_shutdown_destroy(shutdown);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_event_source)
+    {
+#ifdef __linux__
+        const int signums[1] = {SIGUSR2};
+        sigfn_event_source *source(NULL);
+        int flag(INVALID_SIGNUM);
+        size_t dispatched(0);
+        MAXTEST_ASSERT(::sigfn_event_source_create(NULL, 0, &source) == -1);
+        MAXTEST_ASSERT(::sigfn_event_source_create(&signums[0], 1, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_event_source_fd(NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_event_source_dispatch(NULL, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_handle(SIGUSR2, echo_signum, &flag) == 0);
+        MAXTEST_ASSERT(::sigfn_event_source_create(&signums[0], 1, &source) == 0);
+        raise(SIGUSR2);
+        // blocked, so the handler has not run yet
+        MAXTEST_ASSERT(flag == INVALID_SIGNUM);
+        struct pollfd descriptor = {::sigfn_event_source_fd(source), POLLIN, 0};
+        MAXTEST_ASSERT(poll(&descriptor, 1, 1000) == 1);
+        MAXTEST_ASSERT(::sigfn_event_source_dispatch(source, &dispatched) == 0);
+        MAXTEST_ASSERT(dispatched == 1);
+        MAXTEST_ASSERT(flag == SIGUSR2);
+        MAXTEST_ASSERT(::sigfn_event_source_dispatch(source, &dispatched) == 0);
+        MAXTEST_ASSERT(dispatched == 0);
+        ::sigfn_event_source_destroy(source);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_realtime_queue)
+    {
+#ifndef _WIN32 // WINDOWS
+        const int signums[2] = {SIGRTMIN, SIGRTMIN + 1};
+        sigfn_realtime_queue *queue(NULL);
+        sigfn_queued_signal signals[8];
+        size_t drained(0);
+        union sigval value;
+        MAXTEST_ASSERT(::sigfn_realtime_queue_create(NULL, 0, 4, &queue) == -1);
+        MAXTEST_ASSERT(::sigfn_realtime_queue_create(&signums[0], 2, 0, &queue) == -1);
+        MAXTEST_ASSERT(::sigfn_realtime_queue_create(&signums[0], 2, 4, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_realtime_queue_drain(NULL, signals, 8, &drained) == -1);
+        MAXTEST_ASSERT(::sigfn_realtime_queue_overflows(NULL) == 0);
+        MAXTEST_ASSERT(::sigfn_realtime_queue_create(&signums[0], 2, 4, &queue) == 0);
+        for (int index = 0; index < 6; index++)
+        {
+            value.sival_int = index;
+            MAXTEST_ASSERT(sigqueue(getpid(), signums[index % 2], value) == 0);
+        }
+        MAXTEST_ASSERT(::sigfn_realtime_queue_drain(queue, signals, 8, &drained) == 0);
+        MAXTEST_ASSERT(drained == 4);
+        for (size_t index = 0; index < drained; index++)
+        {
+            MAXTEST_ASSERT(signals[index].signum == signums[index % 2]);
+            MAXTEST_ASSERT(signals[index].value.sival_int == (int)index);
+            MAXTEST_ASSERT(signals[index].pid == getpid());
+        }
+        MAXTEST_ASSERT(::sigfn_realtime_queue_overflows(queue) == 2);
+        ::sigfn_realtime_queue_destroy(queue);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_child_watcher)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_child_watcher *watcher(NULL);
+        std::atomic<int> status(INVALID_SIGNUM);
+        size_t reaped(0);
+        MAXTEST_ASSERT(::sigfn_child_watcher_create(NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_child_watcher_create(&watcher) == 0);
+        MAXTEST_ASSERT(::sigfn_child_watch(NULL, 1, record_exit, &status) == -1);
+        MAXTEST_ASSERT(::sigfn_child_watch(watcher, 0, record_exit, &status) == -1);
+        MAXTEST_ASSERT(::sigfn_child_watch(watcher, getpid(), record_exit, &status) == -1);
+        const pid_t pid = spawn_child(7, std::chrono::milliseconds(20));
+        MAXTEST_ASSERT(::sigfn_child_watch(watcher, pid, NULL, &status) == -1);
+        MAXTEST_ASSERT(::sigfn_child_watch(watcher, pid, record_exit, &status) == 0);
+        for (int attempt = 0; attempt < 200 && status == INVALID_SIGNUM; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(status == 7);
+        MAXTEST_ASSERT(::sigfn_child_unwatch(watcher, pid) == 1);
+        MAXTEST_ASSERT(::sigfn_child_unwatch(NULL, pid) == -1);
+        MAXTEST_ASSERT(::sigfn_child_reap(NULL, &reaped) == -1);
+        MAXTEST_ASSERT(::sigfn_child_reap(watcher, &reaped) == 0);
+        MAXTEST_ASSERT(reaped == 0);
+        ::sigfn_child_watcher_destroy(watcher);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_timer_wheel)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_timer_wheel *wheel(NULL);
+        sigfn_timer_id once(0);
+        sigfn_timer_id periodic(0);
+        std::atomic<int> once_calls(0);
+        std::atomic<int> periodic_calls(0);
+        struct timeval tick;
+        struct timeval after;
+        tick.tv_sec = 0;
+        tick.tv_usec = 1000;
+        after.tv_sec = 0;
+        after.tv_usec = 5000;
+        MAXTEST_ASSERT(::sigfn_timer_wheel_create(SIGINT, &tick, &wheel) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_wheel_create(SIGRTMIN + 2, NULL, &wheel) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_wheel_create(SIGRTMIN + 2, &tick, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_wheel_create(SIGRTMIN + 2, &tick, &wheel) == 0);
+        MAXTEST_ASSERT(::sigfn_timer_schedule(NULL, &after, NULL, count_timer, &once_calls, &once) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_schedule(wheel, NULL, NULL, count_timer, &once_calls, &once) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_schedule(wheel, &after, NULL, NULL, &once_calls, &once) == -1);
+        MAXTEST_ASSERT(::sigfn_timer_schedule(wheel, &after, NULL, count_timer, &once_calls, &once) == 0);
+        MAXTEST_ASSERT(::sigfn_timer_schedule(wheel, &tick, &tick, count_timer, &periodic_calls, &periodic) == 0);
+        MAXTEST_ASSERT(once != periodic);
+        for (int attempt = 0; attempt < 200 && (once_calls == 0 || periodic_calls < 10); attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(once_calls == 1);
+        MAXTEST_ASSERT(periodic_calls >= 10);
+        MAXTEST_ASSERT(::sigfn_timer_cancel(wheel, once) == 1);
+        MAXTEST_ASSERT(::sigfn_timer_cancel(wheel, periodic) == 0);
+        MAXTEST_ASSERT(::sigfn_timer_cancel(wheel, periodic) == 1);
+        MAXTEST_ASSERT(::sigfn_timer_cancel(NULL, periodic) == -1);
+        ::sigfn_timer_wheel_destroy(wheel);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_thread_interrupter)
+    {
+#ifndef _WIN32 // WINDOWS
+        const int signum = SIGRTMIN + 3;
+        sigfn_thread_interrupter *interrupter(NULL);
+        sigfn_interrupt_scope *scope(NULL);
+        sigfn_interrupt_scope *nested(NULL);
+        std::atomic<sigfn_thread_token> token(0);
+        std::atomic<bool> done(false);
+        int flag(INVALID_SIGNUM);
+        int error(0);
+        int fds[2];
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        MAXTEST_ASSERT(::sigfn_thread_interrupter_create(SIGINT, &interrupter) == -1);
+        MAXTEST_ASSERT(::sigfn_thread_interrupter_create(signum, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_thread_interrupter_create(signum, &interrupter) == 0);
+        MAXTEST_ASSERT(::sigfn_interrupt_enter(NULL, NULL, NULL, NULL, &scope) == -1);
+        MAXTEST_ASSERT(::sigfn_interrupt_enter(interrupter, NULL, NULL, NULL, NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_interrupt_enter(interrupter, NULL, NULL, NULL, &scope) == 0);
+        MAXTEST_ASSERT(::sigfn_interrupt_enter(interrupter, NULL, NULL, NULL, &nested) == -1);
+        ::sigfn_interrupt_leave(scope);
+        std::thread worker(
+            [&]()
+            {
+                sigfn_thread_token registered(0);
+                sigfn_interrupt_scope *blocked(NULL);
+                char byte;
+                if (::sigfn_interrupt_enter(interrupter, echo_signum, &flag, &registered, &blocked) == 0)
+                {
+                    token = registered;
+                    while (::sigfn_interrupted(blocked) == 0)
+                    {
+                        if (read(fds[0], &byte, 1) == -1)
+                        {
+                            error = errno;
+                        }
+                    }
+                    MAXTEST_ASSERT(::sigfn_interrupt_reset(blocked) == 1);
+                    MAXTEST_ASSERT(::sigfn_interrupt_reset(blocked) == 0);
+                    ::sigfn_interrupt_leave(blocked);
+                }
+                done = true;
+            });
+        while (token == 0 && !done)
+        {
+            std::this_thread::yield();
+        }
+        // a signal that lands before read() blocks only sets the flag, so resend
+        while (!done)
+        {
+            MAXTEST_ASSERT(::sigfn_thread_interrupt(interrupter, token) != -1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        worker.join();
+        MAXTEST_ASSERT(flag == signum);
+        MAXTEST_ASSERT(error == EINTR);
+        MAXTEST_ASSERT(::sigfn_thread_interrupt(interrupter, token) == 1);
+        MAXTEST_ASSERT(::sigfn_thread_interrupt(NULL, token) == -1);
+        MAXTEST_ASSERT(::sigfn_interrupted(NULL) == 0);
+        MAXTEST_ASSERT(::sigfn_interrupt_reset(NULL) == -1);
+        ::sigfn_thread_interrupter_destroy(interrupter);
+        close(fds[0]);
+        close(fds[1]);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_stats)
+    {
+        sigfn_signal_stats stats;
+        int flag(INVALID_SIGNUM);
+        uint64_t histogram(0);
+        MAXTEST_ASSERT(::sigfn_stats_reset() == PASS);
+        MAXTEST_ASSERT(::sigfn_handle(SIGINT, echo_signum, &flag) == PASS);
+        raise(SIGINT);
+        raise(SIGINT);
+        MAXTEST_ASSERT(::sigfn_stats(SIGINT, &stats) == PASS);
+        MAXTEST_ASSERT(stats.signum == SIGINT);
+        MAXTEST_ASSERT(stats.deliveries == 2);
+        MAXTEST_ASSERT(stats.invocations == 2);
+        MAXTEST_ASSERT(stats.max_handler_ns <= stats.handler_ns);
+        for (int index = 0; index < SIGFN_HISTOGRAM_BUCKETS; index++)
+        {
+            histogram += stats.histogram[index];
+        }
+        MAXTEST_ASSERT(histogram == stats.invocations);
+        MAXTEST_ASSERT(::sigfn_stats(INVALID_SIGNUM, &stats) == -1);
+        MAXTEST_ASSERT(::sigfn_stats(SIGINT, nullptr) == -1);
+    };
+
+    MAXTEST_TEST_CASE(sigfn_trace)
+    {
+#ifndef _WIN32 // WINDOWS
+        int fds[2];
+        int flag(INVALID_SIGNUM);
+        sigfn_trace_header header;
+        sigfn_trace_event event;
+        bool traced(false);
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        MAXTEST_ASSERT(::sigfn_trace_start(0, 16) == -1);
+        MAXTEST_ASSERT(::sigfn_trace_start(4, 16) == PASS);
+        MAXTEST_ASSERT(::sigfn_handle(SIGINT, echo_signum, &flag) == PASS);
+        raise(SIGINT);
+        MAXTEST_ASSERT(::sigfn_trace_stop() == PASS);
+        MAXTEST_ASSERT(::sigfn_trace_dump(fds[1], 2) == -1);
+        MAXTEST_ASSERT(::sigfn_trace_dump(fds[1], SIGFN_TRACE_BINARY) == PASS);
+        close(fds[1]);
+        MAXTEST_ASSERT(read(fds[0], &header, sizeof(header)) == sizeof(header));
+        MAXTEST_ASSERT(std::memcmp(header.magic, "SIGFNTRC", sizeof(header.magic)) == 0);
+        MAXTEST_ASSERT(header.event_size == sizeof(sigfn_trace_event));
+        while (read(fds[0], &event, sizeof(event)) == sizeof(event))
+        {
+            if (event.signum == SIGINT && event.delivered_ns != 0)
+            {
+                traced = (event.entered_ns != 0 && event.entered_ns <= event.exited_ns);
+            }
+        }
+        close(fds[0]);
+        MAXTEST_ASSERT(traced);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_profiler)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_profiler *profiler(NULL);
+        uint64_t samples(0);
+        uint64_t dropped(0);
+        MAXTEST_ASSERT(::sigfn_profiler_create(0, 4, 64, &profiler) == -1);
+        MAXTEST_ASSERT(::sigfn_profiler_start(NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_profiler_create(1000, 4, 64, &profiler) == PASS);
+        MAXTEST_ASSERT(::sigfn_profiler_start(profiler) == PASS);
+        spin_for(std::chrono::milliseconds(200));
+        MAXTEST_ASSERT(::sigfn_profiler_stop(profiler) == PASS);
+        MAXTEST_ASSERT(::sigfn_profiler_counts(profiler, &samples, &dropped) == PASS);
+        MAXTEST_ASSERT(samples > 0);
+        const std::string folded = dump_file(
+            [&](int fd)
+            {
+                MAXTEST_ASSERT(::sigfn_profiler_dump(profiler, fd) == PASS);
+            });
+        MAXTEST_ASSERT(folded_samples(folded) == samples);
+        MAXTEST_ASSERT(::sigfn_profiler_clear(profiler) == PASS);
+        MAXTEST_ASSERT(::sigfn_profiler_counts(profiler, &samples, NULL) == PASS);
+        MAXTEST_ASSERT(samples == 0);
+        ::sigfn_profiler_destroy(profiler);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_sigpipe_suppress)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigfn_sigpipe_guard outer;
+        sigfn_sigpipe_guard inner;
+        sigset_t mask;
+        sigset_t waiting;
+        int fds[2];
+        const char byte('x');
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        close(fds[0]);
+        MAXTEST_ASSERT(::sigfn_sigpipe_suppress(NULL) == -1);
+        MAXTEST_ASSERT(::sigfn_sigpipe_suppress(&outer) == PASS);
+        MAXTEST_ASSERT(::sigfn_sigpipe_suppress(&inner) == PASS);
+        MAXTEST_ASSERT(inner.nested && !outer.nested && outer.restore);
+        MAXTEST_ASSERT(write(fds[1], &byte, 1) == -1 && errno == EPIPE);
+        // only the outermost scope consumes the signal
+        MAXTEST_ASSERT(::sigfn_sigpipe_restore(&inner) == PASS);
+        MAXTEST_ASSERT(::sigfn_sigpipe_restore(&outer) == 1);
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, NULL, &mask) == 0);
+        MAXTEST_ASSERT(sigismember(&mask, SIGPIPE) == 0);
+        MAXTEST_ASSERT(sigpending(&waiting) == 0 && sigismember(&waiting, SIGPIPE) == 0);
+        MAXTEST_ASSERT(::sigfn_sigpipe_suppress(&outer) == PASS);
+        MAXTEST_ASSERT(::sigfn_sigpipe_restore(&outer) == PASS);
+        close(fds[1]);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn_crash_install)
+    {
+#ifndef _WIN32 // WINDOWS
+        const int signums[1] = {SIGABRT};
+        int status(0);
+        MAXTEST_ASSERT(::sigfn_crash_install(-1, NULL, 0) == -1);
+        MAXTEST_ASSERT(::sigfn_crash_install(STDERR_FILENO, signums, 0) == -1);
+        const std::string report = crash_child(
+            [&](int fd)
+            {
+                if (::sigfn_crash_install(fd, signums, 1) == 0 && ::sigfn_crash_thread_init() == 0)
+                {
+                    abort();
+                }
+            },
+            status);
+        MAXTEST_ASSERT(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+        MAXTEST_ASSERT(report.find("fatal signal 6 (SIGABRT)") != std::string::npos);
+        MAXTEST_ASSERT(report.find("*** end of report") != std::string::npos);
+        MAXTEST_ASSERT(::sigfn_crash_uninstall() == 0);
+#endif
+    };
+
     MAXTEST_TEST_CASE(sigfn_error)
     {
         int flag;
@@ -246,17 +1092,680 @@ MAXTEST_MAIN
         MAXTEST_ASSERT(flag == 2);
     };
 
-    MAXTEST_TEST_CASE(sigfn::ignore)
+    MAXTEST_TEST_CASE(sigfn::handle_static)
     {
-        const std::function<void(int, bool)> try_catch_assert(
-            [](
-                int signum,
-                bool expect_error)
+        static int flag;
+        int calls(0);
+        flag = 0;
+        sigfn::handle<SIGINT>(
+            [](int signum)
             {
-                bool has_error;
-
-                has_error = false;
-                try
+                flag = signum;
+            });
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
+        // callables without arguments and with captures are supported
+        sigfn::handle<SIGINT>(
+            [&calls]()
+            {
+                calls++;
+            });
+        raise(SIGINT);
+        raise(SIGINT);
+        MAXTEST_ASSERT(calls == 2);
+        // re-registering the same callable type swaps storage buffers
+        for (int index = 0; index < 3; index++)
+        {
+            sigfn::handle<SIGINT>(
+                [&calls, index]()
+                {
+                    calls = index;
+                });
+            raise(SIGINT);
+            MAXTEST_ASSERT(calls == index);
+        }
+        // concurrent registrations of the same callable type are serialized
+        std::atomic<int> last(0);
+        std::vector<std::thread> registrars;
+        for (int thread = 1; thread <= 4; thread++)
+        {
+            registrars.emplace_back(
+                [&last, thread]()
+                {
+                    for (int index = 0; index < 1000; index++)
+                    {
+                        sigfn::handle<SIGINT>(
+                            [&last, thread]()
+                            {
+                                last = thread;
+                            });
+                    }
+                });
+        }
+        for (std::thread &registrar : registrars)
+        {
+            registrar.join();
+        }
+        raise(SIGINT);
+        MAXTEST_ASSERT(last >= 1 && last <= 4);
+#ifndef _WIN32 // WINDOWS
+        // two replacements while a delivery runs on another thread wait for it
+        sigfn::handle<SIGUSR2>(tracked_handler{std::chrono::milliseconds(100)});
+        std::thread slow(
+            []()
+            {
+                raise(SIGUSR2);
+            });
+        while (tracked_handler::running.load() == nullptr)
+        {
+            std::this_thread::yield();
+        }
+        sigfn::handle<SIGUSR2>(tracked_handler{std::chrono::milliseconds(0)});
+        sigfn::handle<SIGUSR2>(tracked_handler{std::chrono::milliseconds(0)});
+        slow.join();
+        MAXTEST_ASSERT(!tracked_handler::destroyed_while_running);
+        sigfn::reset(SIGUSR2);
+#endif
+        // a dynamic handler takes over again
+        sigfn::handle(
+            SIGINT,
+            [&](int signum)
+            {
+                flag = -signum;
+            });
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == -SIGINT);
+    };
+
+    MAXTEST_TEST_CASE(sigfn::handle_concurrent)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::atomic<int> calls(0);
+        std::atomic<bool> running(true);
+        sigfn::handle(
+            SIGUSR1,
+            [&](int signum)
+            {
+                calls++;
+            });
+        std::thread writer(
+            [&]()
+            {
+                while (running)
+                {
+                    sigfn::handle(
+                        SIGUSR1,
+                        [&](int signum)
+                        {
+                            calls++;
+                        });
+                }
+            });
+        for (int i = 0; i < 10000; i++)
+        {
+            raise(SIGUSR1);
+        }
+        running = false;
+        writer.join();
+        MAXTEST_ASSERT(calls == 10000);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::handle_info)
+    {
+#ifndef _WIN32 // WINDOWS
+        int signum(INVALID_SIGNUM);
+        int code(0);
+        pid_t pid(0);
+        uid_t uid(0);
+        bool has_error(false);
+        try
+        {
+            sigfn::handle_info(SIGUSR1, sigfn::info_handler_function());
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_handler);
+        }
+        MAXTEST_ASSERT(has_error);
+        sigfn::handle_info(
+            SIGUSR1,
+            [&](const sigfn::signal_info &info)
+            {
+                signum = info.signum();
+                code = info.code();
+                pid = info.pid();
+                uid = info.uid();
+            },
+            sigfn::restart | sigfn::onstack);
+        kill(getpid(), SIGUSR1);
+        MAXTEST_ASSERT(signum == SIGUSR1);
+        MAXTEST_ASSERT(code == SI_USER);
+        MAXTEST_ASSERT(pid == getpid());
+        MAXTEST_ASSERT(uid == getuid());
+        // replacing it with a plain handler drops the info handler
+        sigfn::handle(
+            SIGUSR1,
+            [&](int value)
+            {
+                signum = -value;
+            });
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(signum == -SIGUSR1);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::defer)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::promise<std::thread::id> promise;
+        std::future<std::thread::id> future = promise.get_future();
+        bool has_error(false);
+        try
+        {
+            sigfn::defer(SIGINT, sigfn::handler_function());
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_handler);
+        }
+        MAXTEST_ASSERT(has_error);
+        sigfn::defer(
+            SIGINT,
+            [&](int signum)
+            {
+                // deferred handlers may allocate and lock
+                promise.set_value(std::this_thread::get_id());
+            });
+        raise(SIGINT);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() != std::this_thread::get_id());
+        sigfn::reset(SIGINT);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::attach)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::array<int, 4> order{};
+        std::atomic<std::size_t> calls(0);
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        struct sigaction action = {};
+        bool has_error(false);
+        try
+        {
+            sigfn::attach(SIGUSR2, sigfn::handler_function());
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_handler);
+        }
+        MAXTEST_ASSERT(has_error);
+        has_error = false;
+        try
+        {
+            sigfn::detach(0);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_token);
+        }
+        MAXTEST_ASSERT(has_error);
+        sigfn::handle(
+            SIGUSR2,
+            [&](int signum)
+            {
+                order[calls++] = 0;
+            });
+        const sigfn::handler_token first = sigfn::attach(
+            SIGUSR2,
+            [&](int signum)
+            {
+                order[calls++] = 1;
+            });
+        const sigfn::handler_token second = sigfn::attach(
+            SIGUSR2,
+            [&](int signum)
+            {
+                order[calls++] = 2;
+            });
+        const sigfn::handler_token deferred = sigfn::attach_deferred(
+            SIGUSR2,
+            [&](int signum)
+            {
+                promise.set_value(signum);
+            });
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(calls == 3);
+        MAXTEST_ASSERT(order[0] == 1 && order[1] == 2 && order[2] == 0);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == SIGUSR2);
+        MAXTEST_ASSERT(sigfn::detach(deferred));
+
+        // replacing the handler leaves the chain in place
+        sigfn::handle(
+            SIGUSR2,
+            [&](int signum)
+            {
+                order[calls++] = 3;
+            });
+        calls = 0;
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(calls == 3);
+        MAXTEST_ASSERT(order[0] == 1 && order[1] == 2 && order[2] == 3);
+
+        MAXTEST_ASSERT(sigfn::detach(first));
+        MAXTEST_ASSERT(!sigfn::detach(first));
+        calls = 0;
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(calls == 2);
+        MAXTEST_ASSERT(order[0] == 2 && order[1] == 3);
+
+        // ignore drops the whole chain
+        sigfn::ignore(SIGUSR2);
+        MAXTEST_ASSERT(!sigfn::detach(second));
+
+        // removing the last handler restores the default action
+        const sigfn::handler_token last = sigfn::attach(
+            SIGUSR2,
+            [&](int signum)
+            {
+                calls++;
+            });
+        MAXTEST_ASSERT(sigfn::detach(last));
+        MAXTEST_ASSERT(sigaction(SIGUSR2, nullptr, &action) == 0);
+        MAXTEST_ASSERT(action.sa_handler == SIG_DFL);
+
+        has_error = false;
+        std::vector<sigfn::handler_token> tokens;
+        try
+        {
+            for (std::size_t index = 0; index <= sigfn::internal::chain_capacity; index++)
+            {
+                tokens.push_back(sigfn::attach(
+                    SIGUSR2,
+                    [](int signum)
+                    {
+                    }));
+            }
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::chain_full);
+        }
+        MAXTEST_ASSERT(has_error);
+        MAXTEST_ASSERT(tokens.size() == sigfn::internal::chain_capacity);
+        sigfn::reset(SIGUSR2);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::attach_exhausted)
+    {
+#if defined(SIGFN_NO_HEAP) && !defined(_WIN32) // WINDOWS
+        // a deferred handler held on the dispatcher keeps retired chains out
+        // of the pool, so attaching and detaching runs it dry
+        std::promise<void> entered;
+        std::promise<void> gate;
+        std::shared_future<void> opened(gate.get_future());
+        const sigfn::handler_function noop(
+            [](int)
+            {
+            });
+        sigfn::defer(
+            SIGUSR1,
+            [&](int)
+            {
+                entered.set_value();
+                opened.wait();
+            });
+        raise(SIGUSR1);
+        entered.get_future().wait();
+        const sigfn::handler_token kept = sigfn::attach(SIGUSR2, noop);
+        bool exhausted(false);
+        for (std::size_t attempt = 0; attempt < sigfn::internal::entry_capacity && !exhausted; attempt++)
+        {
+            try
+            {
+                sigfn::detach(sigfn::attach(SIGUSR2, noop));
+            }
+            catch (const std::exception &e)
+            {
+                exhausted = (e.what() == sigfn::internal::pool_exhausted);
+            }
+        }
+        MAXTEST_ASSERT(exhausted);
+        gate.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        MAXTEST_ASSERT(sigfn::detach(sigfn::attach(SIGUSR2, noop)));
+        MAXTEST_ASSERT(sigfn::detach(kept));
+        sigfn::reset(SIGUSR1);
+        sigfn::reset(SIGUSR2);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::thread_pool)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::atomic<int> active(0);
+        std::atomic<int> overlapped(0);
+        std::atomic<int> runs(0);
+        {
+            sigfn::thread_pool pool(4);
+            MAXTEST_ASSERT(pool.size() == 4);
+            sigfn::defer(
+                SIGUSR1,
+                [&](int)
+                {
+                    if (active.fetch_add(1) != 0)
+                    {
+                        overlapped++;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    active--;
+                    runs++;
+                },
+                pool,
+                sigfn::priority::low);
+            for (int i = 0; i < 50; i++)
+            {
+                raise(SIGUSR1);
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        // the pool reset the signal and drained its work on destruction
+        struct sigaction action;
+        MAXTEST_ASSERT(sigaction(SIGUSR1, nullptr, &action) == 0);
+        MAXTEST_ASSERT(action.sa_handler == SIG_DFL);
+        MAXTEST_ASSERT(runs > 0);
+        MAXTEST_ASSERT(overlapped == 0);
+#ifdef SIGFN_NO_HEAP
+        // handing signals to a pool does not allocate, even with a backlog
+        {
+            constexpr int backlog(20);
+            sigfn::thread_pool pool(1);
+            std::promise<void> gate;
+            std::shared_future<void> opened(gate.get_future());
+            std::atomic<int> ran(0);
+            pool.post(
+                [opened]()
+                {
+                    opened.wait();
+                });
+            for (int offset = 0; offset < backlog; offset++)
+            {
+                sigfn::defer(
+                    SIGRTMIN + offset,
+                    [&ran](int)
+                    {
+                        ran++;
+                    },
+                    pool);
+            }
+            const std::size_t before = allocations.load();
+            for (int offset = 0; offset < backlog; offset++)
+            {
+                raise(SIGRTMIN + offset);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            MAXTEST_ASSERT(allocations.load() == before);
+            gate.set_value();
+            while (ran < backlog)
+            {
+                std::this_thread::yield();
+            }
+        }
+#endif
+
+        // destroyed inside a delivery, on the dispatcher and on another pool
+        {
+            std::unique_ptr<sigfn::thread_pool> doomed(std::make_unique<sigfn::thread_pool>(1));
+            std::promise<void> destroyed;
+            sigfn::defer(
+                SIGUSR2,
+                [&](int)
+                {
+                    doomed.reset();
+                    destroyed.set_value();
+                });
+            raise(SIGUSR2);
+            MAXTEST_ASSERT(destroyed.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        }
+        {
+            sigfn::thread_pool outer(1);
+            std::unique_ptr<sigfn::thread_pool> doomed(std::make_unique<sigfn::thread_pool>(1));
+            std::promise<void> destroyed;
+            sigfn::defer(
+                SIGUSR2,
+                [&](int)
+                {
+                    doomed.reset();
+                    destroyed.set_value();
+                },
+                outer);
+            raise(SIGUSR2);
+            MAXTEST_ASSERT(destroyed.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        }
+
+        // a single worker runs queued high priority work before low priority work
+        std::string order;
+        {
+            sigfn::thread_pool pool(1);
+            std::promise<void> gate;
+            std::shared_future<void> opened(gate.get_future());
+            pool.post(
+                [opened]()
+                {
+                    opened.wait();
+                });
+            pool.post(
+                [&]()
+                {
+                    order += 'L';
+                },
+                sigfn::priority::low);
+            pool(
+                [&]()
+                {
+                    order += 'N';
+                });
+            pool.post(
+                [&]()
+                {
+                    order += 'H';
+                },
+                sigfn::priority::high);
+            gate.set_value();
+        }
+        MAXTEST_ASSERT(order == "HNL");
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::coalesce)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::uint64_t total(0);
+        std::uint64_t batches(0);
+        bool has_error(false);
+        try
+        {
+            sigfn::coalesce(SIGUSR1, sigfn::batch_function());
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_handler);
+        }
+        MAXTEST_ASSERT(has_error);
+        sigfn::coalesce(
+            SIGUSR1,
+            [&](int signum, std::uint64_t count)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                total += count;
+                batches++;
+                condition.notify_all();
+            },
+            std::chrono::milliseconds(100));
+        for (int index = 0; index < 1000; index++)
+        {
+            raise(SIGUSR1);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        MAXTEST_ASSERT(condition.wait_for(
+            lock,
+            std::chrono::seconds(2),
+            [&]()
+            {
+                return total == 1000;
+            }));
+        // a storm inside one window runs the handler a handful of times at most
+        MAXTEST_ASSERT(batches < 10);
+        lock.unlock();
+        sigfn::reset(SIGUSR1);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::watch)
+    {
+        bool has_error(false);
+        try
+        {
+            sigfn::watch(INVALID_SIGNUM);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_syscall);
+        }
+        MAXTEST_ASSERT(has_error);
+        MAXTEST_ASSERT(sigfn::signal_bit(INVALID_SIGNUM) == 0);
+        MAXTEST_ASSERT(sigfn::signal_bit(1) == 1);
+        sigfn::watch(SIGINT);
+        sigfn::watch(SIGTERM);
+        static_cast<void>(sigfn::poll());
+        raise(SIGTERM);
+        raise(SIGINT);
+        raise(SIGINT);
+        MAXTEST_ASSERT(sigfn::pending(SIGINT));
+        MAXTEST_ASSERT(sigfn::pending(SIGTERM));
+        MAXTEST_ASSERT(!sigfn::pending(INVALID_SIGNUM));
+        MAXTEST_ASSERT(sigfn::poll() == (sigfn::signal_bit(SIGINT) | sigfn::signal_bit(SIGTERM)));
+        MAXTEST_ASSERT(!sigfn::pending(SIGINT));
+        MAXTEST_ASSERT(!sigfn::pending(SIGTERM));
+
+        // a watched signal still runs attached handlers
+        int calls(0);
+        const sigfn::handler_token token = sigfn::attach(
+            SIGINT,
+            [&](int signum)
+            {
+                calls++;
+            });
+        raise(SIGINT);
+        MAXTEST_ASSERT(calls == 1);
+        MAXTEST_ASSERT(sigfn::poll() == sigfn::signal_bit(SIGINT));
+        MAXTEST_ASSERT(sigfn::detach(token));
+        sigfn::reset(SIGINT);
+        sigfn::reset(SIGTERM);
+    };
+
+    MAXTEST_TEST_CASE(sigfn::rate_limit)
+    {
+        const std::function<void(const std::function<void()> &)> try_catch_assert(
+            [](const std::function<void()> &function)
+            {
+                bool has_error(false);
+                try
+                {
+                    function();
+                }
+                catch (const std::exception &e)
+                {
+                    has_error = (e.what() == sigfn::internal::invalid_rate);
+                }
+                MAXTEST_ASSERT(has_error);
+            });
+        try_catch_assert([]() { sigfn::rate_limit(SIGUSR1, -1.0); });
+        try_catch_assert([]() { sigfn::rate_limit(SIGUSR1, 1.0, 0); });
+        try_catch_assert([]() { sigfn::rate_limit(SIGUSR1, 1e-300); });
+        try_catch_assert([]() { sigfn::rate_limit(SIGUSR1, 1e-11); });
+        try_catch_assert([]() { sigfn::throttle(SIGUSR1, std::chrono::steady_clock::duration::zero()); });
+        try_catch_assert([]() { sigfn::debounce(SIGUSR1, std::chrono::steady_clock::duration::zero()); });
+
+        // the slowest rate still admits its whole burst
+        std::atomic<int> admitted(0);
+        sigfn::handle(
+            SIGUSR2,
+            [&](int)
+            {
+                admitted++;
+            });
+        sigfn::rate_limit(SIGUSR2, 1e-9, UINT64_MAX);
+        raise(SIGUSR2);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(admitted == 2);
+        sigfn::unlimit(SIGUSR2);
+        sigfn::reset(SIGUSR2);
+
+        // a burst of deliveries runs the handler once after it goes quiet
+        std::atomic<int> calls(0);
+        std::atomic<bool> on_signal_thread(false);
+        const std::thread::id self = std::this_thread::get_id();
+        sigfn::handle(
+            SIGUSR1,
+            [&](int signum)
+            {
+                on_signal_thread = (std::this_thread::get_id() == self);
+                calls++;
+            });
+        sigfn::reset_stats();
+        sigfn::debounce(SIGUSR1, std::chrono::milliseconds(50));
+        for (int index = 0; index < 5; index++)
+        {
+            raise(SIGUSR1);
+        }
+        MAXTEST_ASSERT(calls == 0);
+        for (int attempt = 0; attempt < 100 && calls == 0; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        MAXTEST_ASSERT(calls == 1);
+        MAXTEST_ASSERT(!on_signal_thread);
+        MAXTEST_ASSERT(sigfn::stats(SIGUSR1).suppressed == 4);
+
+        // limits apply to attached handlers as well
+        int attached(0);
+        const sigfn::handler_token token = sigfn::attach(
+            SIGUSR1,
+            [&](int signum)
+            {
+                attached++;
+            });
+        sigfn::throttle(SIGUSR1, std::chrono::minutes(1));
+        raise(SIGUSR1);
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(attached == 1);
+        MAXTEST_ASSERT(calls == 2);
+        sigfn::unlimit(SIGUSR1);
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(attached == 2);
+        MAXTEST_ASSERT(sigfn::detach(token));
+        sigfn::reset(SIGUSR1);
+    };
+
+    MAXTEST_TEST_CASE(sigfn::ignore)
+    {
+        const std::function<void(int, bool)> try_catch_assert(
+            [](
+                int signum,
+                bool expect_error)
+            {
+                bool has_error;
+
+                has_error = false;
+                try
                 {
                     sigfn::ignore(signum);
                 }
@@ -294,6 +1803,1160 @@ MAXTEST_MAIN
         try_catch_assert(SIGINT, false);
     };
 
+    MAXTEST_TEST_CASE(sigfn::stats)
+    {
+#ifndef _WIN32 // WINDOWS
+        std::promise<std::uint64_t> promise;
+        std::future<std::uint64_t> future = promise.get_future();
+        std::vector<sigfn::signal_stats> all;
+        sigfn::reset_stats();
+        sigfn::coalesce(
+            SIGUSR1,
+            [&](int, std::uint64_t count)
+            {
+                promise.set_value(count);
+            },
+            std::chrono::milliseconds(50));
+        raise(SIGUSR1);
+        raise(SIGUSR1);
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+        MAXTEST_ASSERT(future.get() == 3);
+        sigfn::reset(SIGUSR1);
+        const sigfn::signal_stats stats = sigfn::stats(SIGUSR1);
+        MAXTEST_ASSERT(stats.deliveries == 3);
+        MAXTEST_ASSERT(stats.coalesced == 2);
+        MAXTEST_ASSERT(stats.dropped == 0);
+        // the batch handler may still be returning when the future is ready
+        for (int attempt = 0; attempt < 100 && sigfn::stats(SIGUSR1).invocations == 0; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(sigfn::stats(SIGUSR1).invocations == 1);
+        all = sigfn::stats();
+        MAXTEST_ASSERT(std::any_of(
+            all.begin(),
+            all.end(),
+            [](const sigfn::signal_stats &snapshot)
+            {
+                return snapshot.signum == SIGUSR1;
+            }));
+#endif
+        bool has_error(false);
+        try
+        {
+            sigfn::stats(INVALID_SIGNUM);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() != nullptr);
+        }
+        MAXTEST_ASSERT(has_error);
+    };
+
+    MAXTEST_TEST_CASE(sigfn::trace)
+    {
+#ifndef _WIN32 // WINDOWS
+        int fds[2];
+        char buffer[4096];
+        std::string trace;
+        ssize_t size;
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        sigfn::trace_start(4, 16);
+        sigfn::handle(
+            SIGINT,
+            [](int)
+            {
+            });
+        // rings of exited threads are taken over once all are owned
+        for (int index = 0; index < 6; index++)
+        {
+            std::thread(
+                []()
+                {
+                    raise(SIGINT);
+                })
+                .join();
+        }
+        // the dump is attached next to the existing handler
+        int handled(0);
+        sigfn::handle(
+            SIGUSR2,
+            [&](int)
+            {
+                handled++;
+            });
+        const sigfn::handler_token token = sigfn::trace_dump_on(SIGUSR2, fds[1], sigfn::trace_format::chrome);
+        raise(SIGINT);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(handled == 1);
+        MAXTEST_ASSERT(sigfn::detach(token));
+        sigfn::trace_stop();
+        sigfn::reset(SIGUSR2);
+        close(fds[1]);
+        while ((size = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            trace.append(buffer, static_cast<std::size_t>(size));
+        }
+        close(fds[0]);
+        MAXTEST_ASSERT(trace.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+        MAXTEST_ASSERT(trace.find("\"name\":\"handler " + std::to_string(SIGINT) + "\"") != std::string::npos);
+        MAXTEST_ASSERT(trace.find("\"otherData\":{\"dropped\":0}}") != std::string::npos);
+        bool has_error(false);
+        try
+        {
+            sigfn::trace_dump(-1);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() != nullptr);
+        }
+        MAXTEST_ASSERT(has_error);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::profiler)
+    {
+#ifndef _WIN32 // WINDOWS
+        const std::function<void(const std::function<void()> &, const std::string &)> try_catch_assert(
+            [](const std::function<void()> &function, const std::string &expected)
+            {
+                bool has_error(false);
+                try
+                {
+                    function();
+                }
+                catch (const std::exception &e)
+                {
+                    has_error = (e.what() == expected);
+                }
+                MAXTEST_ASSERT(has_error);
+            });
+        try_catch_assert(
+            []()
+            {
+                sigfn::profiler profiler(0);
+            },
+            sigfn::internal::invalid_profiler);
+        {
+            sigfn::profiler released(1000);
+            released.start();
+            spin_for(std::chrono::milliseconds(20));
+        }
+        // a SIGPROF still pending after the profiler is gone is dropped
+        MAXTEST_ASSERT(raise(SIGPROF) == 0);
+
+        sigfn::profiler profiler(1000, 4, 64);
+        sigfn::profiler other(1000);
+        profiler.start();
+        MAXTEST_ASSERT(profiler.running());
+        try_catch_assert(
+            [&]()
+            {
+                other.start();
+            },
+            sigfn::internal::profiler_running);
+        // work on another thread lands in its own ring
+        std::thread worker(
+            []()
+            {
+                spin_for(std::chrono::milliseconds(100));
+            });
+        spin_for(std::chrono::milliseconds(100));
+        worker.join();
+        profiler.stop();
+        MAXTEST_ASSERT(!profiler.running());
+        const std::uint64_t samples = profiler.samples();
+        MAXTEST_ASSERT(samples > 0);
+        const std::string folded = dump_file(
+            [&](int fd)
+            {
+                profiler.dump(fd);
+            });
+        MAXTEST_ASSERT(folded_samples(folded) == samples);
+        // the handler path is trimmed from every stack
+        MAXTEST_ASSERT(folded.find("sample_profiler") == std::string::npos);
+        try_catch_assert(
+            [&]()
+            {
+                profiler.dump(-1);
+            },
+            sigfn::internal::invalid_profile);
+
+        // the timer is free again once the first profiler stopped
+        other.start();
+        spin_for(std::chrono::milliseconds(20));
+        other.stop();
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::suppress_sigpipe)
+    {
+#ifndef _WIN32 // WINDOWS
+        sigset_t sigpipe;
+        sigset_t mask;
+        sigset_t waiting;
+        int fds[2];
+        int signum(0);
+        const char byte('x');
+        sigemptyset(&sigpipe);
+        sigaddset(&sigpipe, SIGPIPE);
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        close(fds[0]);
+        {
+            sigfn::suppress_sigpipe guard;
+            MAXTEST_ASSERT(write(fds[1], &byte, 1) == -1 && errno == EPIPE);
+        }
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, nullptr, &mask) == 0);
+        MAXTEST_ASSERT(sigismember(&mask, SIGPIPE) == 0);
+        MAXTEST_ASSERT(sigpending(&waiting) == 0 && sigismember(&waiting, SIGPIPE) == 0);
+
+        // a SIGPIPE pending before the scope stays pending, and a thread
+        // that already blocked SIGPIPE keeps it blocked
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr) == 0);
+        MAXTEST_ASSERT(pthread_kill(pthread_self(), SIGPIPE) == 0);
+        {
+            sigfn::suppress_sigpipe guard;
+            MAXTEST_ASSERT(write(fds[1], &byte, 1) == -1 && errno == EPIPE);
+        }
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, nullptr, &mask) == 0);
+        MAXTEST_ASSERT(sigismember(&mask, SIGPIPE) == 1);
+        MAXTEST_ASSERT(sigpending(&waiting) == 0 && sigismember(&waiting, SIGPIPE) == 1);
+        MAXTEST_ASSERT(sigwait(&sigpipe, &signum) == 0 && signum == SIGPIPE);
+        MAXTEST_ASSERT(pthread_sigmask(SIG_UNBLOCK, &sigpipe, nullptr) == 0);
+        close(fds[1]);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::crash_install)
+    {
+#ifndef _WIN32 // WINDOWS
+        bool has_error(false);
+        try
+        {
+            sigfn::crash_install(-1);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_crash);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        // a stack overflow is reported from the alternate stack, then the
+        // default action runs
+        int status(0);
+        std::string report = crash_child(
+            [](int fd)
+            {
+                sigfn::crash_install(fd);
+                static_cast<void>(overflow_stack(0));
+            },
+            status);
+        MAXTEST_ASSERT(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+        MAXTEST_ASSERT(report.find("(SIGSEGV)") != std::string::npos);
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+        MAXTEST_ASSERT(report.find("registers:") != std::string::npos);
+#endif
+        MAXTEST_ASSERT(report.find("*** end of report") != std::string::npos);
+
+        // the previous disposition runs after the report
+        report = crash_child(
+            [](int fd)
+            {
+                std::signal(SIGBUS, exit_chained);
+                sigfn::crash_install(fd, {SIGBUS});
+                raise(SIGBUS);
+            },
+            status);
+        MAXTEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 42);
+        MAXTEST_ASSERT(report.find("(SIGBUS)") != std::string::npos);
+
+        // a previous handler that recovers from the fault keeps the process
+        // alive, the faulting write traps again into it
+        report = crash_child(
+            [](int fd)
+            {
+                guarded_page = mmap(nullptr, 4096, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                struct sigaction recover = {};
+                recover.sa_sigaction = unprotect_page;
+                recover.sa_flags = SA_SIGINFO;
+                sigemptyset(&recover.sa_mask);
+                if (guarded_page == MAP_FAILED || sigaction(SIGSEGV, &recover, nullptr) != 0)
+                {
+                    _exit(1);
+                }
+                sigfn::crash_install(fd, {SIGSEGV});
+                *static_cast<volatile char *>(guarded_page) = 1;
+                _exit(*static_cast<volatile char *>(guarded_page) == 1 ? 0 : 1);
+            },
+            status);
+        MAXTEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        MAXTEST_ASSERT(report.find("(SIGSEGV)") != std::string::npos);
+
+        // uninstalling restores the previous disposition
+        struct sigaction action = {};
+        sigfn::crash_install(STDERR_FILENO, {SIGILL});
+        MAXTEST_ASSERT(sigaction(SIGILL, nullptr, &action) == 0);
+        MAXTEST_ASSERT((action.sa_flags & SA_ONSTACK) != 0);
+        sigfn::crash_uninstall();
+        MAXTEST_ASSERT(sigaction(SIGILL, nullptr, &action) == 0);
+        MAXTEST_ASSERT(action.sa_handler == SIG_DFL);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::async_wait)
+    {
+#if defined(SIGFN_COROUTINES) && defined(__cpp_impl_coroutine) && !defined(_WIN32) // WINDOWS
+        constexpr int waiters(1000);
+        std::atomic<int> resumed(0);
+        std::atomic<int> posted(0);
+        std::promise<int> timed_out;
+        std::promise<int> delivered;
+        std::promise<int> stale;
+        std::promise<int> rearmed;
+        const std::function<void(std::function<void()>)> executor(
+            [&](std::function<void()> task)
+            {
+                posted++;
+                task();
+            });
+        for (int waiter = 0; waiter < waiters; waiter++)
+        {
+            await_signal(SIGUSR1, resumed, executor);
+        }
+        raise(SIGUSR1);
+        for (int attempt = 0; attempt < 200 && resumed < waiters; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(resumed == waiters);
+        MAXTEST_ASSERT(posted == waiters);
+
+        await_timeout(SIGUSR2, std::chrono::milliseconds(20), timed_out);
+        MAXTEST_ASSERT(timed_out.get_future().get() == 0);
+
+        // the handler of the signal keeps running alongside the waiter
+        std::atomic<int> handled(0);
+        sigfn::handle(
+            SIGUSR2,
+            [&](int)
+            {
+                handled++;
+            });
+        await_timeout(SIGUSR2, std::chrono::seconds(1), delivered);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(delivered.get_future().get() == SIGUSR2);
+        MAXTEST_ASSERT(handled == 1);
+
+        // delivered while nobody waits, not held for the next waiter
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(handled == 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        await_timeout(SIGUSR2, std::chrono::milliseconds(20), stale);
+        MAXTEST_ASSERT(stale.get_future().get() == 0);
+
+        // a reset between waits does not strand the next waiter
+        sigfn::reset(SIGUSR2);
+        await_timeout(SIGUSR2, std::chrono::seconds(1), rearmed);
+        raise(SIGUSR2);
+        MAXTEST_ASSERT(rearmed.get_future().get() == SIGUSR2);
+        MAXTEST_ASSERT(handled == 2);
+
+        std::promise<bool> failed;
+        await_invalid(failed);
+        MAXTEST_ASSERT(failed.get_future().get());
+
+        // suspended coroutines destroyed while their signal completes them;
+        // the resumptions are dropped, so only the completions touch the frames
+        std::mutex mutex;
+        std::vector<std::function<void()>> dropped;
+        const std::function<void(std::function<void()>)> dropping(
+            [&](std::function<void()> task)
+            {
+                // slow, so a destruction lands while a completion is under way
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                std::lock_guard<std::mutex> lock(mutex);
+                dropped.push_back(std::move(task));
+            });
+        sigfn::handle(
+            SIGUSR1,
+            [](int)
+            {
+            });
+        for (int round = 0; round < 20; round++)
+        {
+            std::vector<owned_task> tasks;
+            for (int waiter = 0; waiter < 100; waiter++)
+            {
+                tasks.push_back(await_owned(SIGUSR1, dropping));
+            }
+            std::thread sender(
+                []()
+                {
+                    for (int signal = 0; signal < 5; signal++)
+                    {
+                        kill(getpid(), SIGUSR1);
+                        std::this_thread::yield();
+                    }
+                });
+            for (owned_task &task : tasks)
+            {
+                task.handle.destroy();
+            }
+            sender.join();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sigfn::reset(SIGUSR1);
+        std::lock_guard<std::mutex> lock(mutex);
+        dropped.clear();
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::inplace_function)
+    {
+        typedef sigfn::inplace_function<int(int)> function_type;
+        int offset(2);
+        bool has_error;
+        int (*null_pointer)(int)(nullptr);
+
+        function_type empty;
+        MAXTEST_ASSERT(!empty);
+        has_error = false;
+        try
+        {
+            empty(0);
+        }
+        catch (const std::bad_function_call &)
+        {
+            has_error = true;
+        }
+        MAXTEST_ASSERT(has_error);
+        MAXTEST_ASSERT(!function_type(null_pointer));
+        MAXTEST_ASSERT(!function_type(std::function<int(int)>()));
+
+        function_type add(
+            [offset](int value)
+            {
+                return value + offset;
+            });
+        function_type copied(add);
+        function_type moved(std::move(add));
+        MAXTEST_ASSERT(copied(1) == 3);
+        MAXTEST_ASSERT(moved(2) == 4);
+        empty = copied;
+        MAXTEST_ASSERT(empty && empty(3) == 5);
+        empty = nullptr;
+        MAXTEST_ASSERT(!empty);
+    };
+
+    MAXTEST_TEST_CASE(sigfn::stop_source)
+    {
+#ifndef _WIN32 // WINDOWS
+        bool has_error(false);
+        try
+        {
+            sigfn::stop_source empty({});
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::empty_sigset);
+        }
+        MAXTEST_ASSERT(has_error);
+        MAXTEST_ASSERT(!sigfn::stop_token().stop_possible());
+        MAXTEST_ASSERT(!sigfn::stop_token().stop_requested());
+
+        {
+            sigfn::stop_source source({SIGUSR2});
+            const sigfn::stop_token token = source.get_token();
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::atomic<int> callbacks(0);
+            const sigfn::stop_callback wake(
+                token,
+                [&]()
+                {
+                    callbacks++;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    condition.notify_all();
+                });
+            MAXTEST_ASSERT(token.stop_possible());
+            MAXTEST_ASSERT(!token.stop_requested());
+
+            // workers sleeping on a condition variable and a thread blocked in a wait
+            std::vector<std::future<bool>> workers;
+            for (int index = 0; index < 8; index++)
+            {
+                workers.push_back(std::async(
+                    std::launch::async,
+                    [&]()
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(
+                            lock,
+                            [&]()
+                            {
+                                return token.stop_requested();
+                            });
+                        return true;
+                    }));
+            }
+            std::atomic<bool> waiting(false);
+            std::future<std::optional<int>> waiter = std::async(
+                std::launch::async,
+                [&]()
+                {
+                    waiting = true;
+                    return sigfn::wait({SIGUSR1}, token);
+                });
+            while (!waiting)
+            {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            raise(SIGUSR2);
+            MAXTEST_ASSERT(token.stop_requested());
+            MAXTEST_ASSERT(waiter.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+            MAXTEST_ASSERT(!waiter.get().has_value());
+            for (std::future<bool> &worker : workers)
+            {
+                MAXTEST_ASSERT(worker.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+                MAXTEST_ASSERT(worker.get());
+            }
+            MAXTEST_ASSERT(callbacks == 1);
+            MAXTEST_ASSERT(!source.request_stop());
+
+            // a callback registered after the stop runs immediately
+            const sigfn::stop_callback late(
+                token,
+                [&]()
+                {
+                    callbacks++;
+                });
+            MAXTEST_ASSERT(callbacks == 2);
+            MAXTEST_ASSERT(!sigfn::wait({SIGUSR1}, token).has_value());
+        }
+
+        {
+            // a stop signal consumed by the wait itself still requests the stop
+            sigfn::stop_source source({SIGUSR2});
+            std::promise<pthread_t> promise;
+            std::future<pthread_t> thread = promise.get_future();
+            std::future<std::optional<int>> waiter = std::async(
+                std::launch::async,
+                [&]()
+                {
+                    // keep an early signal pending until the wait starts
+                    sigset_t blocked;
+                    sigemptyset(&blocked);
+                    sigaddset(&blocked, SIGUSR1);
+                    sigaddset(&blocked, SIGUSR2);
+                    pthread_sigmask(SIG_BLOCK, &blocked, nullptr);
+                    promise.set_value(pthread_self());
+                    return sigfn::wait({SIGUSR1}, source.get_token());
+                });
+            pthread_kill(thread.get(), SIGUSR2);
+            MAXTEST_ASSERT(waiter.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+            MAXTEST_ASSERT(!waiter.get().has_value());
+            MAXTEST_ASSERT(source.stop_requested());
+        }
+
+        {
+            // an unrelated signal completes the wait normally
+            sigfn::stop_source source({SIGUSR2});
+            std::promise<pthread_t> promise;
+            std::future<pthread_t> thread = promise.get_future();
+            std::future<std::optional<int>> waiter = std::async(
+                std::launch::async,
+                [&]()
+                {
+                    // keep an early signal pending until the wait starts
+                    sigset_t blocked;
+                    sigemptyset(&blocked);
+                    sigaddset(&blocked, SIGUSR1);
+                    sigaddset(&blocked, SIGUSR2);
+                    pthread_sigmask(SIG_BLOCK, &blocked, nullptr);
+                    promise.set_value(pthread_self());
+                    return sigfn::wait({SIGUSR1}, source.get_token());
+                });
+            pthread_kill(thread.get(), SIGUSR1);
+            MAXTEST_ASSERT(waiter.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+            MAXTEST_ASSERT(waiter.get() == SIGUSR1);
+            MAXTEST_ASSERT(!source.stop_requested());
+        }
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::shutdown_orchestrator)
+    {
+#ifndef _WIN32 // WINDOWS
+        bool has_error(false);
+        try
+        {
+            sigfn::shutdown_orchestrator empty({});
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::empty_sigset);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        {
+            std::atomic<int> escalations(0);
+            std::atomic<int> arrived(0);
+            // shared with the stuck drain, which outlives the orchestrator
+            const std::shared_ptr<std::atomic<bool>> released = std::make_shared<std::atomic<bool>>(false);
+            sigfn::shutdown_orchestrator orchestrator(
+                {SIGUSR2},
+                [&]()
+                {
+                    escalations++;
+                    *released = true;
+                });
+            has_error = false;
+            try
+            {
+                orchestrator.add("invalid", 0, std::chrono::seconds(1), std::function<void()>());
+            }
+            catch (const std::exception &e)
+            {
+                has_error = (e.what() == sigfn::internal::invalid_handler);
+            }
+            MAXTEST_ASSERT(has_error);
+
+            // each drain of the first stage waits for the other, so they only
+            // finish if the stage runs them in parallel
+            const auto rendezvous = [&]()
+            {
+                arrived++;
+                const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                while (arrived < 2 && std::chrono::steady_clock::now() < deadline)
+                {
+                    std::this_thread::yield();
+                }
+                if (arrived < 2)
+                {
+                    throw std::runtime_error("not parallel");
+                }
+            };
+            orchestrator.add("left", 1, std::chrono::seconds(2), rendezvous);
+            orchestrator.add("right", 1, std::chrono::seconds(2), rendezvous);
+            orchestrator.add(
+                "stuck",
+                2,
+                std::chrono::milliseconds(20),
+                [released]()
+                {
+                    while (!*released)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                });
+            orchestrator.add(
+                "failing",
+                2,
+                std::chrono::seconds(1),
+                []()
+                {
+                    throw std::runtime_error("failing");
+                });
+            orchestrator.add(
+                "skipped",
+                3,
+                std::chrono::seconds(1),
+                []()
+                {
+                });
+            MAXTEST_ASSERT(!orchestrator.requested());
+            raise(SIGUSR2);
+            MAXTEST_ASSERT(orchestrator.requested());
+            const std::vector<sigfn::shutdown_timing> report = orchestrator.wait();
+            MAXTEST_ASSERT(report.size() == 5);
+            MAXTEST_ASSERT(report[0].name == "left" && report[0].status == sigfn::shutdown_status::completed);
+            MAXTEST_ASSERT(report[1].name == "right" && report[1].status == sigfn::shutdown_status::completed);
+            MAXTEST_ASSERT(report[2].name == "stuck" && report[2].status == sigfn::shutdown_status::timed_out);
+            MAXTEST_ASSERT(report[2].elapsed >= std::chrono::milliseconds(20));
+            MAXTEST_ASSERT(report[3].name == "failing" && report[3].status == sigfn::shutdown_status::failed);
+            MAXTEST_ASSERT(report[4].name == "skipped" && report[4].status == sigfn::shutdown_status::skipped);
+            MAXTEST_ASSERT(escalations == 1);
+        }
+
+        {
+            // a second termination signal escalates while the stages drain
+            std::promise<void> escalated;
+            std::future<void> future = escalated.get_future();
+            sigfn::shutdown_orchestrator orchestrator(
+                {SIGUSR2},
+                [&]()
+                {
+                    escalated.set_value();
+                });
+            raise(SIGUSR2);
+            raise(SIGUSR2);
+            MAXTEST_ASSERT(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        }
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::event_source)
+    {
+#ifdef __linux__
+        std::vector<int> received;
+        bool has_error(false);
+        try
+        {
+            sigfn::event_source invalid({});
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::empty_sigset);
+        }
+        MAXTEST_ASSERT(has_error);
+        sigfn::handle(
+            SIGUSR1,
+            [&](int signum)
+            {
+                received.push_back(signum);
+            });
+        sigfn::handle(
+            SIGUSR2,
+            [&](int signum)
+            {
+                received.push_back(signum);
+            });
+        {
+            sigfn::event_source source({SIGUSR1, SIGUSR2});
+            raise(SIGUSR1);
+            raise(SIGUSR2);
+            struct pollfd descriptor = {source.fd(), POLLIN, 0};
+            MAXTEST_ASSERT(poll(&descriptor, 1, 1000) == 1);
+            MAXTEST_ASSERT(source.dispatch() == 2);
+            MAXTEST_ASSERT(received.size() == 2);
+        }
+        // unblocked again once the source is gone
+        raise(SIGUSR1);
+        MAXTEST_ASSERT(received.size() == 3);
+
+        // a signal the thread had blocked before stays blocked
+        sigset_t usr2;
+        sigset_t current;
+        sigemptyset(&usr2);
+        sigaddset(&usr2, SIGUSR2);
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, &usr2, nullptr) == 0);
+        {
+            sigfn::event_source source({SIGUSR1, SIGUSR2});
+        }
+        MAXTEST_ASSERT(pthread_sigmask(SIG_BLOCK, nullptr, &current) == 0);
+        MAXTEST_ASSERT(sigismember(&current, SIGUSR2) == 1);
+        MAXTEST_ASSERT(sigismember(&current, SIGUSR1) == 0);
+        MAXTEST_ASSERT(pthread_sigmask(SIG_UNBLOCK, &usr2, nullptr) == 0);
+
+        // a coalesced handler receives each read delivery as a batch of
+        // one, and a throwing attached handler does not skip the others
+        std::uint64_t batched(0);
+        int attached(0);
+        sigfn::coalesce(
+            SIGUSR2,
+            [&](int, std::uint64_t count)
+            {
+                batched += count;
+            },
+            std::chrono::seconds(1));
+        const sigfn::handler_token throwing = sigfn::attach(
+            SIGUSR2,
+            [](int)
+            {
+                throw std::runtime_error("attached");
+            });
+        const sigfn::handler_token counting = sigfn::attach(
+            SIGUSR2,
+            [&](int)
+            {
+                attached++;
+            });
+        {
+            sigfn::event_source source({SIGUSR2});
+            raise(SIGUSR2);
+            struct pollfd descriptor = {source.fd(), POLLIN, 0};
+            MAXTEST_ASSERT(poll(&descriptor, 1, 1000) == 1);
+            MAXTEST_ASSERT(source.dispatch() == 1);
+        }
+        MAXTEST_ASSERT(batched == 1);
+        MAXTEST_ASSERT(attached == 1);
+        sigfn::detach(throwing);
+        sigfn::detach(counting);
+        sigfn::reset(SIGUSR2);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::realtime_queue)
+    {
+#ifndef _WIN32 // WINDOWS
+        const std::function<void(std::initializer_list<int>, std::size_t, const std::string &)> try_catch_assert(
+            [](
+                std::initializer_list<int> signums,
+                std::size_t capacity,
+                const std::string &expected_error)
+            {
+                std::string actual_error;
+                try
+                {
+                    sigfn::realtime_queue queue(signums, capacity);
+                }
+                catch (const std::exception &e)
+                {
+                    actual_error = e.what();
+                }
+                MAXTEST_ASSERT(expected_error == actual_error);
+            });
+        try_catch_assert({}, 1, sigfn::internal::empty_sigset);
+        try_catch_assert({SIGINT}, 1, sigfn::internal::invalid_realtime);
+        try_catch_assert({SIGRTMIN}, 0, sigfn::internal::invalid_capacity);
+        try_catch_assert({SIGRTMIN}, 1, "");
+        sigfn::realtime_queue queue({SIGRTMAX}, 100);
+        sigfn::queued_signal signals[128];
+        union sigval value;
+        // unlike standard signals, every queued delivery is kept
+        for (int index = 0; index < 100; index++)
+        {
+            value.sival_int = index;
+            MAXTEST_ASSERT(sigqueue(getpid(), SIGRTMAX, value) == 0);
+        }
+        MAXTEST_ASSERT(queue.drain(signals, 10) == 10);
+        MAXTEST_ASSERT(queue.drain(&signals[10], 118) == 90);
+        for (int index = 0; index < 100; index++)
+        {
+            MAXTEST_ASSERT(signals[index].signum == SIGRTMAX);
+            MAXTEST_ASSERT(signals[index].code == SI_QUEUE);
+            MAXTEST_ASSERT(signals[index].value.sival_int == index);
+        }
+        MAXTEST_ASSERT(queue.drain(signals, 128) == 0);
+        MAXTEST_ASSERT(queue.overflows() == 0);
+
+        // a signal arriving after the queue is gone must not terminate the
+        // process, and a handler the queue replaced gets its signal back
+        std::atomic<int> handled(0);
+        sigfn::handle(
+            SIGRTMAX - 1,
+            [&](int)
+            {
+                handled++;
+            });
+        {
+            sigfn::realtime_queue late({SIGRTMIN + 4, SIGRTMAX - 1}, 4);
+        }
+        value.sival_int = 0;
+        MAXTEST_ASSERT(sigqueue(getpid(), SIGRTMIN + 4, value) == 0);
+        MAXTEST_ASSERT(sigqueue(getpid(), SIGRTMAX - 1, value) == 0);
+        MAXTEST_ASSERT(handled == 1);
+        sigfn::reset(SIGRTMAX - 1);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::child_watcher)
+    {
+#ifndef _WIN32 // WINDOWS
+        // a child that exited before any watcher existed is reaped in the calling thread
+        {
+            const pid_t zombie = spawn_child(5, std::chrono::milliseconds(0));
+            siginfo_t info = {};
+            static_cast<void>(waitid(P_PID, static_cast<id_t>(zombie), &info, WEXITED | WNOWAIT));
+            sigfn::child_watcher first;
+            int status(-1);
+            first.watch(
+                zombie,
+                [&status](const sigfn::child_exit &exit)
+                {
+                    status = exit.status;
+                });
+            MAXTEST_ASSERT(status == 5);
+            MAXTEST_ASSERT(first.size() == 0);
+        }
+
+        sigfn::child_watcher watcher;
+        std::mutex mutex;
+        std::unordered_map<pid_t, sigfn::child_exit> exits;
+        const sigfn::child_watcher::exit_function record(
+            [&](const sigfn::child_exit &exit)
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                exits[exit.pid] = exit;
+            });
+        const std::function<std::size_t()> count(
+            [&]()
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                return exits.size();
+            });
+        bool has_error(false);
+        try
+        {
+            watcher.watch(getpid(), record);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_child);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        // every child is reported once, with its own status
+        const int children(64);
+        std::vector<pid_t> pids;
+        for (int index = 0; index < children; index++)
+        {
+            pids.push_back(spawn_child(index, std::chrono::milliseconds(index % 8)));
+            watcher.watch(pids.back(), record);
+        }
+        has_error = false;
+        try
+        {
+            watcher.watch(pids.back(), record);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_child);
+        }
+        MAXTEST_ASSERT(has_error);
+        for (int attempt = 0; attempt < 200 && count() < static_cast<std::size_t>(children); attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(count() == static_cast<std::size_t>(children));
+        MAXTEST_ASSERT(watcher.size() == 0);
+        for (int index = 0; index < children; index++)
+        {
+            MAXTEST_ASSERT(exits[pids[index]].code == CLD_EXITED);
+            MAXTEST_ASSERT(exits[pids[index]].status == index);
+        }
+
+        // a killed child reports its signal
+        const pid_t killed = spawn_child(0, std::chrono::seconds(10));
+        watcher.watch(killed, record);
+        MAXTEST_ASSERT(watcher.size() == 1);
+        MAXTEST_ASSERT(kill(killed, SIGKILL) == 0);
+        for (int attempt = 0; attempt < 200 && count() == static_cast<std::size_t>(children); attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(exits[killed].code == CLD_KILLED);
+        MAXTEST_ASSERT(exits[killed].status == SIGKILL);
+
+        // a child that exited before it was watched is not missed
+        const pid_t early = spawn_child(3, std::chrono::milliseconds(0));
+        siginfo_t info = {};
+        static_cast<void>(waitid(P_PID, static_cast<id_t>(early), &info, WEXITED | WNOWAIT));
+        watcher.watch(early, record);
+        // reaped in the calling thread, or already reaped and claimed there
+        MAXTEST_ASSERT(count() == static_cast<std::size_t>(children + 2));
+        MAXTEST_ASSERT(exits[early].status == 3);
+
+        const pid_t forgotten = spawn_child(0, std::chrono::seconds(10));
+        watcher.watch(forgotten, record);
+        MAXTEST_ASSERT(watcher.unwatch(forgotten));
+        MAXTEST_ASSERT(!watcher.unwatch(forgotten));
+        MAXTEST_ASSERT(watcher.size() == 0);
+        kill(forgotten, SIGKILL);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::timer_wheel)
+    {
+#ifndef _WIN32 // WINDOWS
+        bool has_error(false);
+        try
+        {
+            sigfn::timer_wheel invalid(SIGINT);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_realtime);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        const std::chrono::microseconds tick(100);
+        sigfn::timer_wheel wheel(SIGRTMIN + 2, tick);
+        has_error = false;
+        try
+        {
+            wheel.schedule(tick, sigfn::timer_wheel::timer_function());
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_handler);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        // many timers spread over every level of the wheel fire once, never early
+        const int timers(1000);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::atomic<int> fired(0);
+        std::atomic<int> early(0);
+        for (int index = 0; index < timers; index++)
+        {
+            const std::chrono::microseconds after((index % 10 == 0) ? 500000 : 50000 + index * 200);
+            wheel.schedule(
+                after,
+                [&, after](sigfn::timer_id id, std::uint64_t overruns)
+                {
+                    if (std::chrono::steady_clock::now() - start < after - tick)
+                    {
+                        early++;
+                    }
+                    fired++;
+                });
+        }
+        const sigfn::timer_id cancelled = wheel.schedule(
+            std::chrono::milliseconds(50),
+            [&](sigfn::timer_id id, std::uint64_t overruns)
+            {
+                early++;
+            });
+        MAXTEST_ASSERT(wheel.size() == static_cast<std::size_t>(timers + 1));
+        MAXTEST_ASSERT(wheel.cancel(cancelled));
+        MAXTEST_ASSERT(!wheel.cancel(cancelled));
+        for (int attempt = 0; attempt < 300 && fired < timers; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(fired == timers);
+        MAXTEST_ASSERT(early == 0);
+        MAXTEST_ASSERT(wheel.size() == 0);
+
+        // a periodic timer that falls behind reports the periods it missed
+        std::atomic<int> calls(0);
+        std::atomic<std::uint64_t> missed(0);
+        const sigfn::timer_id periodic = wheel.schedule(
+            tick,
+            [&](sigfn::timer_id id, std::uint64_t overruns)
+            {
+                if (calls++ == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+                missed += overruns;
+            },
+            tick);
+        for (int attempt = 0; attempt < 200 && missed == 0; attempt++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(missed > 0);
+        MAXTEST_ASSERT(wheel.cancel(periodic));
+
+        // an expiry that arrives after the wheel is gone does not terminate
+        {
+            sigfn::timer_wheel released(SIGRTMIN + 7, tick);
+        }
+        MAXTEST_ASSERT(raise(SIGRTMIN + 7) == 0);
+#endif
+    };
+
+    MAXTEST_TEST_CASE(sigfn::thread_interrupter)
+    {
+#ifndef _WIN32 // WINDOWS
+        bool has_error(false);
+        try
+        {
+            sigfn::thread_interrupter invalid(SIGINT);
+        }
+        catch (const std::exception &e)
+        {
+            has_error = (e.what() == sigfn::internal::invalid_realtime);
+        }
+        MAXTEST_ASSERT(has_error);
+
+        sigfn::thread_interrupter interrupter(SIGRTMIN + 3);
+        {
+            sigfn::interrupt_scope scope(interrupter);
+            has_error = false;
+            try
+            {
+                sigfn::interrupt_scope nested(interrupter);
+            }
+            catch (const std::exception &e)
+            {
+                has_error = (e.what() == sigfn::internal::thread_registered);
+            }
+            MAXTEST_ASSERT(has_error);
+            MAXTEST_ASSERT(interrupter.size() == 1);
+            MAXTEST_ASSERT(!scope.interrupted());
+        }
+        MAXTEST_ASSERT(interrupter.size() == 0);
+
+        // only the targeted thread is woken out of its blocking call
+        const int workers(4);
+        int fds[2];
+        MAXTEST_ASSERT(pipe(fds) == 0);
+        std::array<std::atomic<sigfn::thread_token>, workers> tokens{};
+        std::array<std::atomic<int>, workers> callbacks{};
+        std::array<std::atomic<bool>, workers> done{};
+        std::atomic<bool> release(false);
+        std::vector<std::thread> threads;
+        for (int index = 0; index < workers; index++)
+        {
+            threads.emplace_back(
+                [&, index]()
+                {
+                    sigfn::interrupt_scope scope(
+                        interrupter,
+                        [&, index](int signum)
+                        {
+                            callbacks[index]++;
+                        });
+                    tokens[index] = scope.token();
+                    char byte;
+                    while (!scope.interrupted() && !release)
+                    {
+                        static_cast<void>(read(fds[0], &byte, 1));
+                    }
+                    done[index] = true;
+                });
+        }
+        for (int index = 0; index < workers; index++)
+        {
+            while (tokens[index] == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        while (!done[1])
+        {
+            MAXTEST_ASSERT(interrupter.interrupt(tokens[1]));
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        MAXTEST_ASSERT(callbacks[1] > 0);
+        MAXTEST_ASSERT(!done[0] && !done[2] && !done[3]);
+        MAXTEST_ASSERT(callbacks[0] == 0 && callbacks[2] == 0 && callbacks[3] == 0);
+        release = true;
+        const char bytes[workers] = {};
+        MAXTEST_ASSERT(write(fds[1], bytes, sizeof(bytes)) == sizeof(bytes));
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        MAXTEST_ASSERT(!interrupter.interrupt(tokens[1]));
+        MAXTEST_ASSERT(interrupter.size() == 0);
+        close(fds[0]);
+        close(fds[1]);
+
+        // the previous handler comes back, and a late signal does not terminate
+        std::atomic<int> handled(0);
+        sigfn::handle(
+            SIGRTMIN + 5,
+            [&](int)
+            {
+                handled++;
+            });
+        {
+            sigfn::thread_interrupter restored(SIGRTMIN + 5);
+            sigfn::thread_interrupter released(SIGRTMIN + 6);
+        }
+        MAXTEST_ASSERT(raise(SIGRTMIN + 5) == 0);
+        MAXTEST_ASSERT(raise(SIGRTMIN + 6) == 0);
+        MAXTEST_ASSERT(handled == 1);
+        sigfn::reset(SIGRTMIN + 5);
+#endif
+    };
+
     MAXTEST_TEST_CASE(sigfn::wait)
     {
 #ifndef _WIN32 // WINDOWS
@@ -319,6 +2982,19 @@ MAXTEST_MAIN
         try_catch_assert({INVALID_SIGNUM}, true);
         signal_from_child(SIGINT, std::chrono::milliseconds(20));
         try_catch_assert({SIGINT}, false);
+        // waiting must not replace an existing handler
+        int flag(0);
+        sigfn::handle(
+            SIGINT,
+            [&](int signum)
+            {
+                flag = signum;
+            });
+        signal_from_child(SIGINT, std::chrono::milliseconds(20));
+        MAXTEST_ASSERT(sigfn::wait({SIGINT}) == SIGINT);
+        MAXTEST_ASSERT(flag == 0);
+        raise(SIGINT);
+        MAXTEST_ASSERT(flag == SIGINT);
 #endif
     };
 
@@ -353,6 +3029,13 @@ MAXTEST_MAIN
         signal_from_child(SIGINT, std::chrono::milliseconds(20));
         try_catch_assert(SIGINT, false, false);
         try_catch_assert(SIGINT, false, true);
+        // ignored signals can be waited on and stay ignored afterwards
+        struct sigaction action;
+        sigfn::ignore(SIGINT);
+        signal_from_child(SIGINT, std::chrono::milliseconds(20));
+        try_catch_assert(SIGINT, false, false);
+        MAXTEST_ASSERT(sigaction(SIGINT, nullptr, &action) == 0);
+        MAXTEST_ASSERT(action.sa_handler == SIG_IGN);
 #endif
     };
 
@@ -394,4 +3077,36 @@ MAXTEST_MAIN
 void echo_signum(int signum, void *userdata)
 {
     *(int *)userdata = signum;
+}
+
+#ifndef _WIN32 // WINDOWS
+void echo_info(const siginfo_t *info, void *userdata)
+{
+    *(siginfo_t *)userdata = *info;
+}
+
+void record_exit(const sigfn_child_exit *exit, void *userdata)
+{
+    *static_cast<std::atomic<int> *>(userdata) = exit->status;
+}
+
+void count_timer(sigfn_timer_id id, uint64_t overruns, void *userdata)
+{
+    (*static_cast<std::atomic<int> *>(userdata))++;
+}
+#endif
+
+void fulfill_count(int signum, uint64_t count, void *userdata)
+{
+    static_cast<std::promise<uint64_t> *>(userdata)->set_value(count);
+}
+
+void fulfill_signum(int signum, void *userdata)
+{
+    static_cast<std::promise<int> *>(userdata)->set_value(signum);
+}
+
+void count_call(void *userdata)
+{
+    (*static_cast<std::atomic<int> *>(userdata))++;
 }
\ No newline at end of file